@@ -0,0 +1,116 @@
+#ifndef BEHAVIORTREEPROJ_BAIT_BRIDGE_HPP
+#define BEHAVIORTREEPROJ_BAIT_BRIDGE_HPP
+
+#include "bait_static.hpp"
+#include "bait_dynamic.hpp"
+#include "bait_print_static.hpp"
+#include "bait_print_dynamic.hpp"
+#include "bait_snapshot_static.hpp"
+
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace bait {
+
+namespace _detail_bait_static {
+
+// Lives next to dynamic_t so that print_static finds it by argument-dependent lookup, wherever the
+// slot is nested.
+template<typename Stream, typename... Args>
+void print_static(Stream& out, const StaticBT::dynamic_t<DynamicBT<Args...>>& dyn, std::string indent) {
+    out << indent << "dynamic(\n";
+    print_dynamic<Stream, Args...>(out, dyn.value, indent + "    ");
+    out << indent << "),\n";
+}
+
+} // namespace _detail_bait_static
+
+using _detail_bait_static::print_static;
+
+template<typename BT>
+struct Bridge;
+
+// Mixes the two tree models: embed() wraps a StaticBT tree as a single DynamicBT node, so that hot
+// subtrees are fully inlined, and slot() hosts a DynamicBT subtree inside a StaticBT tree. Both
+// simplifiers and both printers see through the boundary, as do Reloader and StateMap.
+template<typename... Args>
+struct Bridge<DynamicBT<Args...>> {
+    using BT = DynamicBT<Args...>;
+    using Func = typename BT::Func;
+    using Info = typename BT::StaticInfo;
+
+    template<typename T>
+    static Func simplify(Func f) {
+        using namespace std;
+        return embed(StaticBT::simplify(move(*f.template target<T>())));
+    }
+
+    template<typename T>
+    static std::string print(const Func& f, const std::string& indent) {
+        std::ostringstream out;
+        print_static(out, *f.template target<T>(), indent);
+        return out.str();
+    }
+
+    // The static part of the state; dynamic slots are reached through slots() instead.
+    template<typename T>
+    using State = _detail_bait_snapshot_static::state<T>;
+
+    template<typename T>
+    static void save(const Func& f, unsigned char* out) {
+        State<T>::save(*f.template target<T>(), out);
+    }
+
+    template<typename T>
+    static void restore(Func& f, const unsigned char* in) {
+        State<T>::restore(*f.template target<T>(), in);
+    }
+
+    template<typename T>
+    static void slots(Func& f, void (* visit)(void*, Func&), void* ctx) {
+        State<T>::visit_slots(*f.template target<T>(), [&](auto& slot) {
+            static_assert(std::is_same<std::decay_t<decltype(slot)>, Func>::value,
+                          "slots inside an embedded tree must hold the embedding tree's Func");
+            visit(ctx, slot);
+        });
+    }
+
+    template<typename T>
+    static void reset(Func& f) {
+        StaticBT::reset(*f.template target<T>());
+    }
+
+    template<typename T>
+    static const Info* info() {
+        static const Info table{simplify<T>, print<T>, State<T>::size, save<T>, restore<T>, reset<T>, slots<T>};
+        return &table;
+    }
+
+    template<typename T>
+    static Func embed(T tree) {
+        using namespace std;
+        return typename BT::RawStatic{move(tree), info<T>()};
+    }
+
+    // Empty series become constants, so that the dynamic simplifier can remove around them.
+    template<status Mode>
+    static Func embed(StaticBT::sequence_t<Mode>) {
+        return typename BT::template constant_t<Mode>();
+    }
+
+    static Func embed(StaticBT::dynamic_t<BT> dyn) {
+        using namespace std;
+        return move(dyn.value);
+    }
+
+    static StaticBT::dynamic_t<BT> slot(Func f) {
+        using namespace std;
+        return StaticBT::dynamic<BT>(move(f));
+    }
+};
+
+} // namespace bait
+
+#endif //BEHAVIORTREEPROJ_BAIT_BRIDGE_HPP
@@ -37,12 +37,29 @@ struct bootstrap_helper<DynamicBT<Args...>> {
             return btfuncs;
         };
 
+        auto to_vector_option = [](const vector<Boxed_Value>& bvs) {
+            vector <typename BT::Option> options;
+            auto cast = [](const Boxed_Value& bv){return boxed_cast<typename BT::Option>(bv);};
+            options.reserve(bvs.size());
+            transform(bvs.begin(), bvs.end(), back_inserter(options), cast);
+            return options;
+        };
+
         m->add(type_conversion<vector<Boxed_Value>, vector<typename BT::Func>>(to_vector_btfunc));
+        m->add(type_conversion<vector<Boxed_Value>, vector<typename BT::Option>>(to_vector_option));
 
         m->add(fun<typename BT::Func(vector<typename BT::Func>)>(BT::sequence), "sequence");
         m->add(fun<typename BT::Func(vector<typename BT::Func>)>(BT::selector), "selector");
         m->add(fun<typename BT::Func(typename BT::Func)>(BT::inverter), "inverter");
         m->add(fun<typename BT::Func(typename BT::Func)>(BT::until_fail), "until_fail");
+        m->add(fun<typename BT::Option(typename BT::Score, typename BT::Func)>(BT::option), "option");
+        m->add(fun<typename BT::Func(float, vector<typename BT::Option>)>(BT::utility), "utility");
+        m->add(fun<typename BT::Func(vector<typename BT::Func>)>(BT::lod), "lod");
+        m->add(fun([](size_t threshold, vector<typename BT::Func> funcs) {
+            return BT::parallel(require(threshold), move(funcs));
+        }), "parallel");
+        m->add(fun<typename BT::Func(typename BT::Func)>(BT::thread_safe), "thread_safe");
+        m->add(fun<typename BT::Func(string, typename BT::Func)>(BT::named), "named");
     }
 };
 
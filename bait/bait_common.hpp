@@ -1,6 +1,7 @@
 #ifndef BEHAVIORTREEPROJ_BAIT_COMMON_HPP
 #define BEHAVIORTREEPROJ_BAIT_COMMON_HPP
 
+#include <cstddef>
 #include <type_traits>
 
 namespace bait {
@@ -15,6 +16,104 @@ static constexpr status flip(status s) {
     return (s == status::SUCCESS ? status::FAILURE : (s == status::FAILURE ? status::SUCCESS : s));
 }
 
+// Utility selection: returns the index of the highest score, where the previous choice gets a
+// bonus of `hysteresis`. Ties go to the first child.
+inline size_t best_utility(const float* scores, size_t count, size_t last, float hysteresis) {
+    size_t best = 0;
+    float best_score = scores[0] + (last == 0 ? hysteresis : 0.f);
+    for (size_t i = 1; i != count; ++i) {
+        float score = scores[i] + (last == i ? hysteresis : 0.f);
+        if (score > best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+// Batched utility selection across agents. `scores` is child-major (scores[child * agents + agent]),
+// `last` holds each agent's previous choice and receives the new one, and `best_scores` is scratch
+// space for `agents` floats. The scoring pass runs across agents so that it vectorizes.
+inline void best_utility(const float* scores, size_t count, size_t agents, size_t* last, float* best_scores,
+                         float hysteresis) {
+    for (size_t a = 0; a != agents; ++a) {
+        best_scores[a] = scores[a] + (last[a] == 0 ? hysteresis : 0.f);
+    }
+    for (size_t i = 1; i != count; ++i) {
+        const float* row = scores + i * agents;
+        for (size_t a = 0; a != agents; ++a) {
+            float score = row[a] + (last[a] == i ? hysteresis : 0.f);
+            best_scores[a] = score > best_scores[a] ? score : best_scores[a];
+        }
+    }
+    for (size_t a = 0; a != agents; ++a) {
+        // Nothing matches when a score is NaN; fall back to the first child as the single-agent version does.
+        size_t best = 0;
+        for (size_t i = count; i-- != 0;) {
+            float score = scores[i * agents + a] + (last[a] == i ? hysteresis : 0.f);
+            best = score == best_scores[a] ? i : best;
+        }
+        last[a] = best;
+    }
+}
+
+// Runs job(ctx, 0) ... job(ctx, count - 1), possibly concurrently, and returns when all are done.
+struct TaskPool {
+    virtual ~TaskPool() = default;
+
+    virtual void run(size_t count, void (* job)(void*, size_t), void* ctx) = 0;
+};
+
+template<typename F>
+void run_job(void* ctx, size_t i) {
+    (*static_cast<F*>(ctx))(i);
+}
+
+// A parallel node succeeds once `success_threshold` children have succeeded (capped at the number of
+// children) and fails once that is no longer possible. Children marked thread_safe are ticked on
+// `pool` when one is given.
+struct ParallelPolicy {
+    static constexpr size_t all = size_t(-1);
+
+    size_t success_threshold = all;
+    TaskPool* pool = nullptr;
+
+    constexpr size_t required(size_t count) const {
+        return success_threshold < count ? success_threshold : count;
+    }
+};
+
+constexpr ParallelPolicy require_all(TaskPool* pool = nullptr) {
+    return {ParallelPolicy::all, pool};
+}
+
+constexpr ParallelPolicy require_one(TaskPool* pool = nullptr) {
+    return {1, pool};
+}
+
+constexpr ParallelPolicy require(size_t threshold, TaskPool* pool = nullptr) {
+    return {threshold, pool};
+}
+
+// Combines the per-child results of a parallel node; RUNNING marks children still to be ticked.
+// Once the node finishes, the node resets its unfinished children and marks every child RUNNING
+// again for the next run.
+inline status parallel_result(const status* results, size_t count, size_t required) {
+    size_t successes = 0;
+    size_t failures = 0;
+    for (size_t i = 0; i != count; ++i) {
+        successes += (results[i] == status::SUCCESS);
+        failures += (results[i] == status::FAILURE);
+    }
+    status result = status::RUNNING;
+    if (successes >= required) {
+        result = status::SUCCESS;
+    } else if (failures > count - required) {
+        result = status::FAILURE;
+    }
+    return result;
+}
+
 enum class Optimization {
     NONE,
     UNWRAP_INVERTERS,
@@ -0,0 +1,505 @@
+#ifndef BEHAVIORTREEPROJ_BAIT_DSL_STATIC_HPP
+#define BEHAVIORTREEPROJ_BAIT_DSL_STATIC_HPP
+
+#include "bait_static.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+namespace bait {
+
+namespace _detail_bait_dsl_static {
+
+using namespace std;
+
+// Grammar:
+//     node := '!' node
+//           | 'succeed' | 'fail'
+//           | ('sequence' | 'selector') '(' [node {',' node}] ')'
+//           | ('inverter' | 'until_fail') '(' node ')'
+//           | leaf-name
+//
+// Leaf names are looked up in the source's comma separated leaf list, which also
+// gives the order of the leaves passed to make().
+
+enum class kind {
+    LEAF,
+    SEQUENCE,
+    SELECTOR,
+    INVERTER,
+    UNTIL_FAIL,
+    SUCCEED,
+    FAIL
+};
+
+constexpr size_t npos = size_t(-1);
+
+struct node {
+    kind type = kind::LEAF;
+    size_t leaf = npos;
+    size_t first_child = npos;
+    size_t next_sibling = npos;
+    size_t child_count = 0;
+};
+
+template<size_t N>
+struct node_table {
+    node nodes[N];
+    size_t size = 0;
+    size_t root = npos;
+};
+
+constexpr bool is_ident(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+constexpr bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+constexpr bool equal(const char* a, size_t alen, const char* b) {
+    size_t i = 0;
+    for (; i != alen; ++i) {
+        if (b[i] != a[i]) {
+            return false;
+        }
+    }
+    return b[i] == '\0';
+}
+
+// Upper bound on the number of nodes: every node starts with a name or a '!'.
+constexpr size_t count_nodes(const char* src) {
+    size_t count = 0;
+    for (size_t i = 0; src[i]; ++i) {
+        if (src[i] == '!' || (is_ident(src[i]) && (i == 0 || !is_ident(src[i - 1])))) {
+            ++count;
+        }
+    }
+    return count == 0 ? 1 : count;
+}
+
+constexpr size_t find_leaf(const char* leaves, const char* name, size_t len) {
+    size_t index = 0;
+    size_t i = 0;
+    while (leaves[i]) {
+        while (is_space(leaves[i]) || leaves[i] == ',') {
+            ++i;
+        }
+        size_t start = i;
+        while (is_ident(leaves[i])) {
+            ++i;
+        }
+        if (i == start) {
+            if (leaves[i]) {
+                throw invalid_argument("bait dsl: bad character in leaf list");
+            }
+            break;
+        }
+        if (i - start == len) {
+            bool match = true;
+            for (size_t j = 0; j != len; ++j) {
+                if (leaves[start + j] != name[j]) {
+                    match = false;
+                }
+            }
+            if (match) {
+                return index;
+            }
+        }
+        ++index;
+    }
+    throw invalid_argument("bait dsl: unknown leaf");
+}
+
+template<size_t N>
+struct parser {
+    const char* src;
+    const char* leaves;
+    size_t pos = 0;
+    node_table<N> table = {};
+    size_t size = 0;
+
+    constexpr parser(const char* src, const char* leaves) : src(src), leaves(leaves) { }
+
+    constexpr void skip() {
+        while (is_space(src[pos])) {
+            ++pos;
+        }
+    }
+
+    constexpr bool accept(char c) {
+        skip();
+        if (src[pos] == c) {
+            ++pos;
+            return true;
+        }
+        return false;
+    }
+
+    constexpr void expect(char c) {
+        if (!accept(c)) {
+            throw invalid_argument("bait dsl: unexpected character");
+        }
+    }
+
+    constexpr size_t add(kind type) {
+        if (size == N) {
+            throw invalid_argument("bait dsl: too many nodes");
+        }
+        table.nodes[size].type = type;
+        return size++;
+    }
+
+    constexpr void add_child(size_t parent, size_t child) {
+        auto& p = table.nodes[parent];
+        if (p.child_count == 0) {
+            p.first_child = child;
+        } else {
+            size_t last = p.first_child;
+            while (table.nodes[last].next_sibling != npos) {
+                last = table.nodes[last].next_sibling;
+            }
+            table.nodes[last].next_sibling = child;
+        }
+        ++p.child_count;
+    }
+
+    constexpr size_t parse_node() {
+        if (accept('!')) {
+            size_t inv = add(kind::INVERTER);
+            add_child(inv, parse_node());
+            return inv;
+        }
+
+        skip();
+        const char* name = src + pos;
+        size_t len = 0;
+        while (is_ident(src[pos])) {
+            ++pos;
+            ++len;
+        }
+        if (len == 0) {
+            throw invalid_argument("bait dsl: expected a node");
+        }
+
+        if (equal(name, len, "succeed")) {
+            return add(kind::SUCCEED);
+        } else if (equal(name, len, "fail")) {
+            return add(kind::FAIL);
+        } else if (equal(name, len, "sequence") || equal(name, len, "selector")) {
+            size_t seq = add(equal(name, len, "sequence") ? kind::SEQUENCE : kind::SELECTOR);
+            expect('(');
+            if (!accept(')')) {
+                do {
+                    add_child(seq, parse_node());
+                } while (accept(','));
+                expect(')');
+            }
+            return seq;
+        } else if (equal(name, len, "inverter") || equal(name, len, "until_fail")) {
+            size_t dec = add(equal(name, len, "inverter") ? kind::INVERTER : kind::UNTIL_FAIL);
+            expect('(');
+            add_child(dec, parse_node());
+            expect(')');
+            return dec;
+        } else {
+            size_t leaf = add(kind::LEAF);
+            table.nodes[leaf].leaf = find_leaf(leaves, name, len);
+            return leaf;
+        }
+    }
+};
+
+template<size_t N>
+constexpr node_table<N> parse(const char* src, const char* leaves) {
+    parser<N> p(src, leaves);
+    p.table.root = p.parse_node();
+    p.skip();
+    if (src[p.pos]) {
+        throw invalid_argument("bait dsl: trailing characters");
+    }
+    p.table.size = p.size;
+    return p.table;
+}
+
+template<Optimization... Opts>
+constexpr bool enabled(Optimization opt) {
+    const Optimization opts[] = {Optimization::NONE, Opts...};
+    for (auto o : opts) {
+        if (o == opt || o == Optimization::ALL ||
+            (o == Optimization::QUICK &&
+             (opt == Optimization::UNWRAP_INVERTERS || opt == Optimization::UNWRAP_SERIES))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Applies the requested optimizations to the node table, so that only the simplified tree is ever
+// instantiated. Empty series are stored as SUCCEED/FAIL.
+template<size_t N, Optimization... Opts>
+struct simplifier {
+    node_table<N> table;
+
+    constexpr simplifier(const node_table<N>& table) : table(table) { }
+
+    static constexpr bool is_series(kind k, kind mode) {
+        return k == mode || k == (mode == kind::SEQUENCE ? kind::SUCCEED : kind::FAIL);
+    }
+
+    static constexpr kind flip(kind mode) {
+        return mode == kind::SEQUENCE ? kind::SELECTOR : kind::SEQUENCE;
+    }
+
+    constexpr size_t add(kind type) {
+        if (table.size == N) {
+            throw invalid_argument("bait dsl: too many nodes");
+        }
+        table.nodes[table.size] = node{};
+        table.nodes[table.size].type = type;
+        return table.size++;
+    }
+
+    constexpr size_t wrap(size_t child) {
+        size_t inv = add(kind::INVERTER);
+        table.nodes[inv].first_child = child;
+        table.nodes[inv].child_count = 1;
+        table.nodes[child].next_sibling = npos;
+        return inv;
+    }
+
+    constexpr void append(size_t parent, size_t& last, size_t child) {
+        auto& p = table.nodes[parent];
+        table.nodes[child].next_sibling = npos;
+        if (p.child_count == 0) {
+            p.first_child = child;
+        } else {
+            table.nodes[last].next_sibling = child;
+        }
+        last = child;
+        ++p.child_count;
+    }
+
+    constexpr size_t simplify(size_t i) {
+        auto type = table.nodes[i].type;
+        if (type == kind::INVERTER || type == kind::UNTIL_FAIL) {
+            size_t c = simplify(table.nodes[i].first_child);
+            if (type == kind::INVERTER && enabled<Opts...>(Optimization::UNWRAP_INVERTERS) &&
+                table.nodes[c].type == kind::INVERTER) {
+                return table.nodes[c].first_child;
+            }
+            table.nodes[i].first_child = c;
+            table.nodes[c].next_sibling = npos;
+            return i;
+        } else if (type == kind::SEQUENCE || type == kind::SELECTOR) {
+            return simplify_series(i, type);
+        } else {
+            return i;
+        }
+    }
+
+    constexpr size_t simplify_series(size_t i, kind mode) {
+        kind stop = (mode == kind::SEQUENCE ? kind::FAIL : kind::SUCCEED);
+        size_t c = table.nodes[i].first_child;
+        size_t last = npos;
+        table.nodes[i].first_child = npos;
+        table.nodes[i].child_count = 0;
+
+        for (bool done = false; c != npos && !done;) {
+            size_t next = table.nodes[c].next_sibling;
+            size_t s = simplify(c);
+            if (enabled<Opts...>(Optimization::FLATTEN_SERIES) && is_series(table.nodes[s].type, mode)) {
+                for (size_t g = table.nodes[s].first_child; g != npos;) {
+                    size_t gnext = table.nodes[g].next_sibling;
+                    append(i, last, g);
+                    g = gnext;
+                }
+                done = enabled<Opts...>(Optimization::REMOVE_UNREACHABLE) && last != npos &&
+                       table.nodes[last].type == stop;
+            } else if (enabled<Opts...>(Optimization::REMOVE_UNREACHABLE) && is_series(table.nodes[s].type, mode) &&
+                       table.nodes[s].child_count == 0) {
+                // No-op constant
+            } else {
+                append(i, last, s);
+                done = enabled<Opts...>(Optimization::REMOVE_UNREACHABLE) && table.nodes[s].type == stop;
+            }
+            c = next;
+        }
+
+        auto count = table.nodes[i].child_count;
+
+        if (count == 0) {
+            table.nodes[i].type = (mode == kind::SEQUENCE ? kind::SUCCEED : kind::FAIL);
+            return i;
+        }
+
+        if (enabled<Opts...>(Optimization::UNWRAP_SERIES) && count == 1) {
+            return table.nodes[i].first_child;
+        }
+
+        if (enabled<Opts...>(Optimization::MINIMIZE_SERIES_INVERSION)) {
+            size_t inverted = 0;
+            for (size_t k = table.nodes[i].first_child; k != npos; k = table.nodes[k].next_sibling) {
+                if (table.nodes[k].type == kind::INVERTER) {
+                    ++inverted;
+                }
+            }
+            if (inverted > count - inverted + 1) {
+                size_t k = table.nodes[i].first_child;
+                last = npos;
+                table.nodes[i].first_child = npos;
+                table.nodes[i].child_count = 0;
+                table.nodes[i].type = flip(mode);
+                while (k != npos) {
+                    size_t next = table.nodes[k].next_sibling;
+                    append(i, last, table.nodes[k].type == kind::INVERTER ? table.nodes[k].first_child : wrap(k));
+                    k = next;
+                }
+                return wrap(i);
+            }
+        }
+
+        return i;
+    }
+};
+
+template<size_t N, Optimization... Opts>
+constexpr node_table<N> simplify(const node_table<N>& table) {
+    simplifier<N, Opts...> s(table);
+    s.table.root = s.simplify(s.table.root);
+    return s.table;
+}
+
+template<typename Source>
+struct parsed {
+    static constexpr size_t capacity = 2 * count_nodes(Source::tree());
+    static constexpr node_table<capacity> table = parse<capacity>(Source::tree(), Source::leaves());
+};
+
+template<typename Source>
+constexpr size_t parsed<Source>::capacity;
+
+template<typename Source>
+constexpr node_table<parsed<Source>::capacity> parsed<Source>::table;
+
+template<typename Source, Optimization... Opts>
+struct simplified {
+    static constexpr node_table<parsed<Source>::capacity> table =
+            simplify<parsed<Source>::capacity, Opts...>(parsed<Source>::table);
+};
+
+template<typename Source, Optimization... Opts>
+constexpr node_table<parsed<Source>::capacity> simplified<Source, Opts...>::table;
+
+template<typename Table>
+constexpr size_t child(size_t i, size_t k) {
+    size_t c = Table::table.nodes[i].first_child;
+    for (; k != 0; --k) {
+        c = Table::table.nodes[c].next_sibling;
+    }
+    return c;
+}
+
+template<typename Table, size_t I, kind K, typename... Leaves>
+struct build;
+
+template<typename Table, size_t I, typename... Leaves>
+using build_node = build<Table, I, Table::table.nodes[I].type, Leaves...>;
+
+template<typename Table, size_t I, typename... Leaves>
+struct build<Table, I, kind::LEAF, Leaves...> {
+    static constexpr size_t leaf = Table::table.nodes[I].leaf;
+    static_assert(leaf < sizeof...(Leaves), "bait dsl: not enough leaves passed");
+
+    using type = tuple_element_t<leaf, tuple<Leaves...>>;
+
+    static type make(const tuple<Leaves...>& leaves) {
+        return get<leaf>(leaves);
+    }
+};
+
+template<typename Table, size_t I, status Mode, typename Ks, typename... Leaves>
+struct build_serial;
+
+template<typename Table, size_t I, status Mode, size_t... Ks, typename... Leaves>
+struct build_serial<Table, I, Mode, integer_sequence<size_t, Ks...>, Leaves...> {
+    using type = StaticBT::sequence_t<Mode,
+            typename build_node<Table, child<Table>(I, Ks), Leaves...>::type...>;
+
+    static type make(const tuple<Leaves...>& leaves) {
+        return type(make_tuple(build_node<Table, child<Table>(I, Ks), Leaves...>::make(leaves)...));
+    }
+};
+
+template<typename Table, size_t I, status Mode, typename... Leaves>
+using build_serial_node = build_serial<Table, I, Mode,
+        make_integer_sequence<size_t, Table::table.nodes[I].child_count>, Leaves...>;
+
+template<typename Table, size_t I, typename... Leaves>
+struct build<Table, I, kind::SEQUENCE, Leaves...> : build_serial_node<Table, I, status::SUCCESS, Leaves...> {
+};
+
+template<typename Table, size_t I, typename... Leaves>
+struct build<Table, I, kind::SELECTOR, Leaves...> : build_serial_node<Table, I, status::FAILURE, Leaves...> {
+};
+
+template<typename Table, size_t I, typename... Leaves>
+struct build<Table, I, kind::SUCCEED, Leaves...> : build_serial_node<Table, I, status::SUCCESS, Leaves...> {
+};
+
+template<typename Table, size_t I, typename... Leaves>
+struct build<Table, I, kind::FAIL, Leaves...> : build_serial_node<Table, I, status::FAILURE, Leaves...> {
+};
+
+template<typename Table, size_t I, typename... Leaves>
+struct build<Table, I, kind::INVERTER, Leaves...> {
+    using child = build_node<Table, Table::table.nodes[I].first_child, Leaves...>;
+    using type = StaticBT::inverter_t<typename child::type>;
+
+    static type make(const tuple<Leaves...>& leaves) {
+        return type(child::make(leaves));
+    }
+};
+
+template<typename Table, size_t I, typename... Leaves>
+struct build<Table, I, kind::UNTIL_FAIL, Leaves...> {
+    using child = build_node<Table, Table::table.nodes[I].first_child, Leaves...>;
+    using type = StaticBT::until_fail_t<typename child::type>;
+
+    static type make(const tuple<Leaves...>& leaves) {
+        return type(child::make(leaves));
+    }
+};
+
+template<typename Source, Optimization... Opts>
+struct StaticDSL {
+    using raw_table = parsed<Source>;
+    using table = simplified<Source, Opts...>;
+
+    template<typename... Leaves>
+    using raw_type = typename build_node<raw_table, raw_table::table.root, Leaves...>::type;
+
+    template<typename... Leaves>
+    using type = typename build_node<table, table::table.root, Leaves...>::type;
+
+    template<typename... Leaves>
+    static raw_type<Leaves...> make_raw(Leaves... leaves) {
+        return build_node<raw_table, raw_table::table.root, Leaves...>::make(make_tuple(move(leaves)...));
+    }
+
+    template<typename... Leaves>
+    static type<Leaves...> make(Leaves... leaves) {
+        return build_node<table, table::table.root, Leaves...>::make(make_tuple(move(leaves)...));
+    }
+};
+
+} // namespace _detail_bait_dsl_static
+
+using _detail_bait_dsl_static::StaticDSL;
+
+} // namespace bait
+
+#endif //BEHAVIORTREEPROJ_BAIT_DSL_STATIC_HPP
@@ -4,9 +4,12 @@
 #include "bait_common.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <vector>
+#include <type_traits>
 #include <functional>
 #include <iterator>
+#include <string>
 #include <utility>
 
 namespace bait {
@@ -27,6 +30,7 @@ static auto vector_cat(vector<T>&& s1, vector<T>&& s2) {
 template<typename... Args>
 struct DynamicBT {
     using Func = function<status(Args...)>;
+    using Score = function<float(Args...)>;
 
     template<status Mode>
     struct RawSerial {
@@ -93,6 +97,227 @@ struct DynamicBT {
         }
     };
 
+    struct RawNamed {
+        string name;
+        Func child;
+
+        RawNamed(string name, Func child) : name(move(name)), child(move(child)) { }
+
+        status operator()(Args&& ... args) {
+            return child(forward<Args>(args)...);
+        }
+    };
+
+    struct Option {
+        Score score;
+        Func child;
+    };
+
+    struct RawUtility {
+        vector<Score> scores;
+        vector<Func> children;
+        vector<float> values;
+        float hysteresis;
+        size_t current = size_t(-1);
+        size_t preselected = size_t(-1);
+
+        RawUtility(vector<Option> options, float hysteresis) : values(options.size()), hysteresis(hysteresis) {
+            scores.reserve(options.size());
+            children.reserve(options.size());
+            for (auto& o : options) {
+                scores.push_back(move(o.score));
+                children.push_back(move(o.child));
+            }
+        }
+
+        void choose(size_t best) {
+            if (current < children.size() && best != current) {
+                reset(children[current]);
+            }
+            current = best;
+        }
+
+        // Makes the next tick switch to option `best` without scoring; see UtilityBatch.
+        void preselect(size_t best) {
+            preselected = best;
+        }
+
+        status operator()(Args&& ... args) {
+            auto sz = children.size();
+            if (sz == 0) {
+                return status::FAILURE;
+            }
+            if (preselected < sz) {
+                choose(preselected);
+            } else {
+                for (size_t i = 0; i != sz; ++i) {
+                    values[i] = scores[i](args...);
+                }
+                choose(best_utility(values.data(), sz, current, hysteresis));
+            }
+            preselected = size_t(-1);
+            return children[current](forward<Args>(args)...);
+        }
+    };
+
+    struct RawLod {
+        vector<Func> levels;
+
+        RawLod(vector<Func> levels) : levels(move(levels)) { }
+
+        status operator()(Args&& ... args) {
+            return levels.front()(forward<Args>(args)...);
+        }
+    };
+
+    struct RawTraced {
+        uint32_t id;
+        Func child;
+        void (* record)(uint32_t, status);
+
+        RawTraced(uint32_t id, Func child, void (* record)(uint32_t, status)) : id(id), child(move(child)),
+                                                                                record(record) { }
+
+        status operator()(Args&& ... args) {
+            status result = child(forward<Args>(args)...);
+            record(id, result);
+            return result;
+        }
+    };
+
+    // Marks a subtree as safe to tick concurrently with its siblings in a parallel node.
+    struct RawThreadSafe {
+        Func child;
+
+        status operator()(Args&& ... args) {
+            return child(forward<Args>(args)...);
+        }
+    };
+
+    static bool is_thread_safe(const Func& f) {
+        if (auto ptr = f.template target<RawTraced>()) {
+            return is_thread_safe(ptr->child);
+        }
+        return bool(f.template target<RawThreadSafe>());
+    }
+
+    struct RawParallel {
+        vector<Func> children;
+        vector<status> results;
+        vector<size_t> pending;
+        ParallelPolicy policy;
+
+        RawParallel(vector<Func> children, ParallelPolicy policy)
+                : children(move(children)), results(this->children.size(), status::RUNNING), policy(policy) {
+            pending.reserve(this->children.size());
+        }
+
+        status operator()(Args&& ... args) {
+            // Every child sees the same arguments, and pooled children read them concurrently, so they are
+            // passed as lvalues that no child can move from.
+            auto sz = children.size();
+            pending.clear();
+            for (size_t i = 0; i != sz; ++i) {
+                if (results[i] == status::RUNNING) {
+                    if (policy.pool && is_thread_safe(children[i])) {
+                        pending.push_back(i);
+                    } else {
+                        results[i] = children[i](args...);
+                    }
+                }
+            }
+            if (pending.size() == 1) {
+                results[pending[0]] = children[pending[0]](args...);
+            } else if (!pending.empty()) {
+                auto job = [&](size_t k) { results[pending[k]] = children[pending[k]](args...); };
+                policy.pool->run(pending.size(), run_job<decltype(job)>, &job);
+            }
+            auto result = parallel_result(results.data(), sz, policy.required(sz));
+            if (result != status::RUNNING) {
+                restart();
+            }
+            return result;
+        }
+
+        // Resets the children that were left RUNNING and clears the results for the next run.
+        void restart() {
+            for (size_t i = 0; i != children.size(); ++i) {
+                if (results[i] == status::RUNNING) {
+                    reset(children[i]);
+                }
+                results[i] = status::RUNNING;
+            }
+        }
+    };
+
+    // Leaf or decorator whose snapshot_state() exposes trivially copyable tick state.
+    struct RawStateful {
+        Func child;
+        void* (* state)(Func&);
+        size_t size;
+
+        status operator()(Args&& ... args) {
+            return child(forward<Args>(args)...);
+        }
+    };
+
+    // Type-erased view of an embedded StaticBT tree, filled in by Bridge::embed (see bait_bridge.hpp).
+    struct StaticInfo {
+        Func (* simplify)(Func);
+        string (* print)(const Func&, const string& indent);
+        size_t size;
+        void (* save)(const Func&, unsigned char*);
+        void (* restore)(Func&, const unsigned char*);
+        void (* reset)(Func&);
+        void (* slots)(Func&, void (* visit)(void*, Func&), void* ctx);
+    };
+
+    // Statically typed subtree ticked as a single node.
+    struct RawStatic {
+        Func child;
+        const StaticInfo* info;
+
+        status operator()(Args&& ... args) {
+            return child(forward<Args>(args)...);
+        }
+    };
+
+    // Returns a subtree that was left RUNNING to its initial state, following only its running path.
+    static void reset(Func& f) {
+        if (auto n = f.template target<RawSequence>()) {
+            if (n->current < n->children.size()) {
+                reset(n->children[n->current]);
+            }
+            n->current = 0;
+        } else if (auto n = f.template target<RawSelector>()) {
+            if (n->current < n->children.size()) {
+                reset(n->children[n->current]);
+            }
+            n->current = 0;
+        } else if (auto n = f.template target<RawUtility>()) {
+            if (n->current < n->children.size()) {
+                reset(n->children[n->current]);
+            }
+            n->current = size_t(-1);
+        } else if (auto n = f.template target<RawParallel>()) {
+            n->restart();
+        } else if (auto n = f.template target<RawInverter>()) {
+            reset(n->child);
+        } else if (auto n = f.template target<RawUntilFail>()) {
+            reset(n->child);
+        } else if (auto n = f.template target<RawNamed>()) {
+            reset(n->child);
+        } else if (auto n = f.template target<RawTraced>()) {
+            reset(n->child);
+        } else if (auto n = f.template target<RawThreadSafe>()) {
+            reset(n->child);
+        } else if (auto n = f.template target<RawLod>()) {
+            reset(n->levels.front());
+        } else if (auto n = f.template target<RawStatic>()) {
+            n->info->reset(n->child);
+        }
+    }
+
     template<typename... Ts>
     static constexpr Func sequence(Ts&& ... ts) {
         return RawSequence({forward<Ts>(ts)...});
@@ -119,6 +344,53 @@ struct DynamicBT {
         return RawUntilFail(move(t));
     }
 
+    static Option option(Score score, Func t) {
+        return {move(score), move(t)};
+    }
+
+    template<typename... Ts>
+    static Func utility(float hysteresis, Ts&& ... ts) {
+        return RawUtility({forward<Ts>(ts)...}, hysteresis);
+    }
+
+    static Func utility(float hysteresis, vector<Option> options) {
+        return RawUtility(move(options), hysteresis);
+    }
+
+    template<typename... Ts>
+    static Func lod(Func t, Ts&& ... ts) {
+        return RawLod({move(t), forward<Ts>(ts)...});
+    }
+
+    static Func lod(vector<Func> levels) {
+        return RawLod(move(levels));
+    }
+
+    template<typename... Ts>
+    static Func parallel(ParallelPolicy policy, Ts&& ... ts) {
+        return RawParallel({forward<Ts>(ts)...}, policy);
+    }
+
+    static Func parallel(ParallelPolicy policy, vector<Func> funcs) {
+        return RawParallel(move(funcs), policy);
+    }
+
+    static Func thread_safe(Func t) {
+        return RawThreadSafe{move(t)};
+    }
+
+    template<typename T>
+    static Func stateful(T t) {
+        using State = remove_reference_t<decltype(t.snapshot_state())>;
+        static_assert(is_trivially_copyable<State>::value, "snapshot_state() must be trivially copyable");
+        auto state = [](Func& f) -> void* { return &f.template target<T>()->snapshot_state(); };
+        return RawStateful{move(t), state, sizeof(State)};
+    }
+
+    static Func named(string name, Func t) {
+        return RawNamed(move(name), move(t));
+    }
+
     template<status Mode>
     struct constant_t {
         constexpr status operator()(Args...) const {
@@ -165,26 +437,25 @@ struct Simplifier<DynamicBT<Args...>, Opts...> {
 
         // Remove unreachable children
         if (is_in<Optimization::REMOVE_UNREACHABLE,Opts...>()) {
-            auto is_instant_success = [](auto& f) {
+            auto is_instant_continue = [](auto& f) {
                 return bool(f.template target<typename BT::template constant_t < Mode>>
                         ());
             };
-            auto is_instant_fail = [](auto& f) {
+            auto is_instant_return = [](auto& f) {
                 return bool(f.template target<typename BT::template constant_t < flip(Mode)>>
                         ());
             };
-            auto success_iter = find_if(finalvec.begin(), finalvec.end(), is_instant_success);
-            if (success_iter != finalvec.end()) {
-                finalvec.erase(next(success_iter), finalvec.end());
+            auto return_iter = find_if(finalvec.begin(), finalvec.end(), is_instant_return);
+            if (return_iter != finalvec.end()) {
+                finalvec.erase(next(return_iter), finalvec.end());
             }
-            auto fail_iter = find_if(finalvec.begin(), finalvec.end(), is_instant_fail);
-            finalvec.erase(fail_iter, finalvec.end());
+            finalvec.erase(remove_if(finalvec.begin(), finalvec.end(), is_instant_continue), finalvec.end());
         }
 
         // Unwrap singular or empty series
         if (is_in<Optimization::UNWRAP_SERIES,Opts...>()) {
             if (finalvec.size() == 0) {
-                return typename BT::succeed();
+                return typename BT::template constant_t<Mode>();
             } else if (finalvec.size() == 1) {
                 return move(finalvec.front());
             }
@@ -227,6 +498,91 @@ struct Simplifier<DynamicBT<Args...>, Opts...> {
         return uf;
     }
 
+    typename BT::Func simplify(typename BT::RawUtility ut) const {
+        using namespace std;
+        for (auto& f : ut.children) {
+            f = simplify(move(f));
+        }
+        if (is_in<Optimization::UNWRAP_SERIES,Opts...>()) {
+            if (ut.children.size() == 1) {
+                return move(ut.children.front());
+            }
+        }
+        return ut;
+    }
+
+    typename BT::Func simplify(typename BT::RawParallel par) const {
+        using namespace std;
+        vector<typename BT::Func> finalvec = move(par.children);
+        vector<typename BT::Func> tmpvec;
+
+        // Simplify children
+        for (auto& f : finalvec) {
+            f = simplify(move(f));
+        }
+
+        // Flatten nested require-all or require-one parallels with the same policy
+        auto threshold = par.policy.success_threshold;
+        if (is_in<Optimization::FLATTEN_SERIES,Opts...>() && (threshold == ParallelPolicy::all || threshold == 1)) {
+            tmpvec.reserve(finalvec.size());
+            for (auto& f : finalvec) {
+                auto ptr = f.template target<typename BT::RawParallel>();
+                if (ptr && !ptr->children.empty() && ptr->policy.success_threshold == threshold &&
+                    ptr->policy.pool == par.policy.pool) {
+                    move(ptr->children.begin(), ptr->children.end(), back_inserter(tmpvec));
+                } else {
+                    tmpvec.push_back(move(f));
+                }
+            }
+            swap(tmpvec, finalvec);
+        }
+
+        // Unwrap a single child that alone decides the result
+        if (is_in<Optimization::UNWRAP_SERIES,Opts...>()) {
+            if (finalvec.size() == 1 && par.policy.required(1) == 1) {
+                return move(finalvec.front());
+            }
+        }
+
+        return typename BT::RawParallel(move(finalvec), par.policy);
+    }
+
+    typename BT::Func simplify(typename BT::RawThreadSafe ts) const {
+        using namespace std;
+        ts.child = simplify(move(ts.child));
+        return ts;
+    }
+
+    typename BT::Func simplify(typename BT::RawLod lod) const {
+        using namespace std;
+        for (auto& f : lod.levels) {
+            f = simplify(move(f));
+        }
+        if (is_in<Optimization::UNWRAP_SERIES,Opts...>()) {
+            if (lod.levels.size() == 1) {
+                return move(lod.levels.front());
+            }
+        }
+        return lod;
+    }
+
+    typename BT::Func simplify(typename BT::RawNamed nm) const {
+        using namespace std;
+        nm.child = simplify(move(nm.child));
+        return nm;
+    }
+
+    typename BT::Func simplify(typename BT::RawTraced tr) const {
+        using namespace std;
+        tr.child = simplify(move(tr.child));
+        return tr;
+    }
+
+    typename BT::Func simplify(typename BT::RawStatic st) const {
+        using namespace std;
+        return st.info->simplify(move(st.child));
+    }
+
     // Dispatcher
     typename BT::Func simplify(typename BT::Func tree) const {
         using namespace std;
@@ -238,6 +594,20 @@ struct Simplifier<DynamicBT<Args...>, Opts...> {
             return simplify(move(*branch));
         } else if (auto branch = tree.template target<typename BT::RawUntilFail>()) {
             return simplify(move(*branch));
+        } else if (auto branch = tree.template target<typename BT::RawUtility>()) {
+            return simplify(move(*branch));
+        } else if (auto branch = tree.template target<typename BT::RawParallel>()) {
+            return simplify(move(*branch));
+        } else if (auto branch = tree.template target<typename BT::RawThreadSafe>()) {
+            return simplify(move(*branch));
+        } else if (auto branch = tree.template target<typename BT::RawLod>()) {
+            return simplify(move(*branch));
+        } else if (auto branch = tree.template target<typename BT::RawNamed>()) {
+            return simplify(move(*branch));
+        } else if (auto branch = tree.template target<typename BT::RawTraced>()) {
+            return simplify(move(*branch));
+        } else if (auto branch = tree.template target<typename BT::RawStatic>()) {
+            return simplify(move(*branch));
         } else if (auto branch = tree.template target<typename BT::Func>()) {
             return simplify(move(*branch));
         } else {
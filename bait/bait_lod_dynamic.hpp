@@ -0,0 +1,154 @@
+#ifndef BEHAVIORTREEPROJ_BAIT_LOD_DYNAMIC_HPP
+#define BEHAVIORTREEPROJ_BAIT_LOD_DYNAMIC_HPP
+
+#include "bait_dynamic.hpp"
+#include "bait_reload_dynamic.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace bait {
+
+template<typename BT, Optimization... Opts>
+struct LodReducer;
+
+template<typename... Args, Optimization... Opts>
+struct LodReducer<DynamicBT<Args...>, Opts...> {
+    using BT = DynamicBT<Args...>;
+    using Func = typename BT::Func;
+
+    // Replaces every lod node with its variant for `level`; the last variant covers all higher levels.
+    void reduce(Func& tree, size_t level) const {
+        using namespace std;
+        while (auto lod = tree.template target<typename BT::RawLod>()) {
+            auto variant = move(lod->levels[min(level, lod->levels.size() - 1)]);
+            tree = move(variant);
+        }
+        for (size_t i = 0; auto c = Reloader<BT>::child(tree, i); ++i) {
+            reduce(*c, level);
+        }
+    }
+
+    Func operator()(Func tree, size_t level) const {
+        using namespace std;
+        reduce(tree, level);
+        return Simplifier<BT, Opts...>()(move(tree));
+    }
+};
+
+// Ticks a population of agents that share one tree. Each LOD level has a reduced variant of the
+// tree, built once up front, and a tick period; agents on a level are ticked every `period` frames,
+// staggered by agent index, and a period of 0 stops ticking altogether. The tree is simplified once
+// with its lod nodes in place and each level is reduced from that without simplifying again, so the
+// variants never flatten into their parents and every level has the same structure outside its lod
+// nodes. When an agent changes level, all of that state is carried over; a lod node whose variant
+// changes starts the new variant over.
+template<typename BT, Optimization... Opts>
+struct LodRunner;
+
+template<typename... Args, Optimization... Opts>
+struct LodRunner<DynamicBT<Args...>, Opts...> {
+    using BT = DynamicBT<Args...>;
+    using Func = typename BT::Func;
+
+    struct Level {
+        Func tree;
+        size_t period;
+    };
+
+    struct Agent {
+        Func tree;
+        size_t level;
+        status last;
+    };
+
+    Func base;
+    std::vector<Level> levels;
+    std::vector<Agent> agents;
+    size_t frame = 0;
+
+    LodRunner(const Func& tree, const std::vector<size_t>& periods) : base(Simplifier<BT, Opts...>()(tree)) {
+        if (periods.empty()) {
+            throw std::invalid_argument("bait lod: at least one level is required");
+        }
+        levels.reserve(periods.size());
+        for (size_t i = 0; i != periods.size(); ++i) {
+            Func reduced = base;
+            LodReducer<BT, Opts...>().reduce(reduced, i);
+            levels.push_back({std::move(reduced), periods[i]});
+        }
+    }
+
+    size_t clamp(size_t level) const {
+        return std::min(level, levels.size() - 1);
+    }
+
+    size_t add_agent(size_t level = 0) {
+        level = clamp(level);
+        agents.push_back({levels[level].tree, level, status::RUNNING});
+        return agents.size() - 1;
+    }
+
+    // Copies the state of `from`, reduced from `node` for level `from_level`, into `to`, reduced from
+    // the same node for `to_level`.
+    void carry(const Func& node, const Func& from, size_t from_level, Func& to, size_t to_level) const {
+        using namespace std;
+        if (auto lod = node.template target<typename BT::RawLod>()) {
+            auto last = lod->levels.size() - 1;
+            auto variant = min(from_level, last);
+            if (variant == min(to_level, last)) {
+                carry(lod->levels[variant], from, from_level, to, to_level);
+            }
+            return;
+        }
+        if (auto src = from.template target<typename BT::RawSequence>()) {
+            to.template target<typename BT::RawSequence>()->current = src->current;
+        } else if (auto src = from.template target<typename BT::RawSelector>()) {
+            to.template target<typename BT::RawSelector>()->current = src->current;
+        } else if (auto src = from.template target<typename BT::RawUtility>()) {
+            to.template target<typename BT::RawUtility>()->current = src->current;
+        } else if (auto src = from.template target<typename BT::RawParallel>()) {
+            to.template target<typename BT::RawParallel>()->results = src->results;
+        } else if (from.template target<typename BT::RawStateful>() || from.template target<typename BT::RawStatic>()) {
+            Reloader<BT>().remap(from, to);
+        }
+        for (size_t i = 0; auto c = Reloader<BT>::child(node, i); ++i) {
+            carry(*c, *Reloader<BT>::child(from, i), from_level, *Reloader<BT>::child(to, i), to_level);
+        }
+    }
+
+    void set_lod(size_t agent, size_t level) {
+        using namespace std;
+        auto& a = agents[agent];
+        level = clamp(level);
+        if (level != a.level) {
+            Func fresh = levels[level].tree;
+            carry(base, a.tree, a.level, fresh, level);
+            a.tree = move(fresh);
+            a.level = level;
+        }
+    }
+
+    // Calls invoke(agent_index, tree) for every agent due this frame and records the returned status.
+    // Returns the number of agents ticked.
+    template<typename Invoke>
+    size_t tick(Invoke&& invoke) {
+        size_t ticked = 0;
+        for (size_t i = 0; i != agents.size(); ++i) {
+            auto& a = agents[i];
+            auto period = levels[a.level].period;
+            if (period != 0 && (frame + i) % period == 0) {
+                a.last = invoke(i, a.tree);
+                ++ticked;
+            }
+        }
+        ++frame;
+        return ticked;
+    }
+};
+
+} // namespace bait
+
+#endif //BEHAVIORTREEPROJ_BAIT_LOD_DYNAMIC_HPP
@@ -18,7 +18,7 @@ template <typename Stream, typename... Args>
 void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawSequence& seq, string indent) {
     out << indent << "sequence(\n";
     for (auto& f : seq.children) {
-        print_dynamic(out, f, indent + "    ");
+        print_dynamic<Stream, Args...>(out, f, indent + "    ");
     }
     out << indent << "),\n";
 }
@@ -27,7 +27,7 @@ template <typename Stream, typename... Args>
 void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawSelector& seq, string indent) {
     out << indent << "selector(\n";
     for (auto& f : seq.children) {
-        print_dynamic(out, f, indent + "    ");
+        print_dynamic<Stream, Args...>(out, f, indent + "    ");
     }
     out << indent << "),\n";
 }
@@ -35,27 +35,98 @@ void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawSelector&
 template <typename Stream, typename... Args>
 void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawInverter& inv, string indent) {
     out << indent << "inverter(\n";
-    print_dynamic(out, inv.child, indent + "    ");
+    print_dynamic<Stream, Args...>(out, inv.child, indent + "    ");
     out << indent << "),\n";
 }
 
 template <typename Stream, typename... Args>
 void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawUntilFail& uf, string indent) {
     out << indent << "until_fail(\n";
-    print_dynamic(out, uf.child, indent + "    ");
+    print_dynamic<Stream, Args...>(out, uf.child, indent + "    ");
+    out << indent << "),\n";
+}
+
+template <typename Stream, typename... Args>
+void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawUtility& ut, string indent) {
+    out << indent << "utility(\n";
+    for (auto& f : ut.children) {
+        out << indent << "    option(\n";
+        out << indent << "        SCORE,\n";
+        print_dynamic<Stream, Args...>(out, f, indent + "        ");
+        out << indent << "    ),\n";
+    }
+    out << indent << "),\n";
+}
+
+template <typename Stream, typename... Args>
+void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawParallel& par, string indent) {
+    out << indent << "parallel(";
+    if (par.policy.success_threshold == ParallelPolicy::all) {
+        out << "all";
+    } else {
+        out << par.policy.success_threshold;
+    }
+    out << ",\n";
+    for (auto& f : par.children) {
+        print_dynamic<Stream, Args...>(out, f, indent + "    ");
+    }
+    out << indent << "),\n";
+}
+
+template <typename Stream, typename... Args>
+void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawThreadSafe& ts, string indent) {
+    out << indent << "thread_safe(\n";
+    print_dynamic<Stream, Args...>(out, ts.child, indent + "    ");
+    out << indent << "),\n";
+}
+
+template <typename Stream, typename... Args>
+void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawLod& lod, string indent) {
+    out << indent << "lod(\n";
+    for (auto& f : lod.levels) {
+        print_dynamic<Stream, Args...>(out, f, indent + "    ");
+    }
+    out << indent << "),\n";
+}
+
+template <typename Stream, typename... Args>
+void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawNamed& nm, string indent) {
+    out << indent << "named(\"" << nm.name << "\",\n";
+    print_dynamic<Stream, Args...>(out, nm.child, indent + "    ");
+    out << indent << "),\n";
+}
+
+template <typename Stream, typename... Args>
+void print_dynamic(Stream& out, const typename DynamicBT<Args...>::RawStatic& st, string indent) {
+    out << indent << "static(\n";
+    out << st.info->print(st.child, indent + "    ");
     out << indent << "),\n";
 }
 
 template <typename Stream, typename... Args>
 void print_dynamic(Stream& out, const typename DynamicBT<Args...>::Func& tree, string indent) {
     if (auto branch = tree.template target<typename DynamicBT<Args...>::RawSequence>()) {
-        return print_dynamic(out, *branch, indent);
+        return print_dynamic<Stream, Args...>(out, *branch, indent);
     } else if (auto branch = tree.template target<typename DynamicBT<Args...>::RawSelector>()) {
-        return print_dynamic(out, *branch, indent);
+        return print_dynamic<Stream, Args...>(out, *branch, indent);
     } else if (auto branch = tree.template target<typename DynamicBT<Args...>::RawInverter>()) {
-        return print_dynamic(out, *branch, indent);
+        return print_dynamic<Stream, Args...>(out, *branch, indent);
     } else if (auto branch = tree.template target<typename DynamicBT<Args...>::RawUntilFail>()) {
-        return print_dynamic(out, *branch, indent);
+        return print_dynamic<Stream, Args...>(out, *branch, indent);
+    } else if (auto branch = tree.template target<typename DynamicBT<Args...>::RawUtility>()) {
+        return print_dynamic<Stream, Args...>(out, *branch, indent);
+    } else if (auto branch = tree.template target<typename DynamicBT<Args...>::RawParallel>()) {
+        return print_dynamic<Stream, Args...>(out, *branch, indent);
+    } else if (auto branch = tree.template target<typename DynamicBT<Args...>::RawThreadSafe>()) {
+        return print_dynamic<Stream, Args...>(out, *branch, indent);
+    } else if (auto branch = tree.template target<typename DynamicBT<Args...>::RawLod>()) {
+        return print_dynamic<Stream, Args...>(out, *branch, indent);
+    } else if (auto branch = tree.template target<typename DynamicBT<Args...>::RawNamed>()) {
+        return print_dynamic<Stream, Args...>(out, *branch, indent);
+    } else if (auto branch = tree.template target<typename DynamicBT<Args...>::RawTraced>()) {
+        return print_dynamic<Stream, Args...>(out, branch->child, indent);
+    } else if (auto branch = tree.template target<typename DynamicBT<Args...>::RawStatic>()) {
+        return print_dynamic<Stream, Args...>(out, *branch, indent);
     } else {
         out << indent << "LEAF,\n";
     }
@@ -17,6 +17,35 @@ using std::string;
 using std::tuple;
 using std::get;
 
+// Declared up front so that nested nodes find every overload, whatever their leaf types.
+
+template<typename Stream, typename T>
+void print_static(Stream& out, const StaticBT::inverter_t<T>& iv, string indent);
+
+template<typename Stream, typename T>
+void print_static(Stream& out, const StaticBT::until_fail_t<T>& iv, string indent);
+
+template<typename Stream, typename S, typename T>
+void print_static(Stream& out, const StaticBT::option_t<S, T>& op, string indent);
+
+template<typename Stream, typename... Ts>
+void print_static(Stream& out, const StaticBT::sequence_t<status::SUCCESS, Ts...>& iv, string indent);
+
+template<typename Stream, typename... Ts>
+void print_static(Stream& out, const StaticBT::sequence_t<status::FAILURE, Ts...>& iv, string indent);
+
+template<typename Stream, typename... Os>
+void print_static(Stream& out, const StaticBT::utility_t<Os...>& ut, string indent);
+
+template<typename Stream, typename... Ts>
+void print_static(Stream& out, const StaticBT::parallel_t<Ts...>& par, string indent);
+
+template<typename Stream, typename T>
+void print_static(Stream& out, const StaticBT::thread_safe_t<T>& ts, string indent);
+
+template<typename Stream, typename... Ts>
+void print_static(Stream& out, const StaticBT::lod_t<Ts...>& lod, string indent);
+
 template<typename Stream, typename T>
 void print_static(Stream& out, const T&, string indent) {
     out << indent << "LEAF,\n";
@@ -36,6 +65,14 @@ void print_static(Stream& out, const StaticBT::until_fail_t<T>& iv, string inden
     out << indent << "),\n";
 }
 
+template<typename Stream, typename S, typename T>
+void print_static(Stream& out, const StaticBT::option_t<S, T>& op, string indent) {
+    out << indent << "option(\n";
+    out << indent << "    SCORE,\n";
+    print_static(out, op.child, indent + "    ");
+    out << indent << "),\n";
+}
+
 template<typename Stream, typename... Ts, size_t... Is>
 void print_static(Stream& out, const tuple<Ts...>& tup, string indent, integer_sequence<size_t, Is...>) {
     using intarr = int[sizeof...(Ts)];
@@ -56,6 +93,40 @@ void print_static(Stream& out, const StaticBT::sequence_t<status::FAILURE, Ts...
     out << indent << "),\n";
 }
 
+template<typename Stream, typename... Os>
+void print_static(Stream& out, const StaticBT::utility_t<Os...>& ut, string indent) {
+    out << indent << "utility(\n";
+    print_static(out, ut.value, indent + "    ", make_integer_sequence<size_t, sizeof...(Os)>());
+    out << indent << "),\n";
+}
+
+template<typename Stream, typename... Ts>
+void print_static(Stream& out, const StaticBT::parallel_t<Ts...>& par, string indent) {
+    out << indent << "parallel(";
+    if (par.policy.success_threshold == ParallelPolicy::all) {
+        out << "all";
+    } else {
+        out << par.policy.success_threshold;
+    }
+    out << ",\n";
+    print_static(out, par.value, indent + "    ", make_integer_sequence<size_t, sizeof...(Ts)>());
+    out << indent << "),\n";
+}
+
+template<typename Stream, typename T>
+void print_static(Stream& out, const StaticBT::thread_safe_t<T>& ts, string indent) {
+    out << indent << "thread_safe(\n";
+    print_static(out, ts.value, indent + "    ");
+    out << indent << "),\n";
+}
+
+template<typename Stream, typename... Ts>
+void print_static(Stream& out, const StaticBT::lod_t<Ts...>& lod, string indent) {
+    out << indent << "lod(\n";
+    print_static(out, lod.value, indent + "    ", make_integer_sequence<size_t, sizeof...(Ts)>());
+    out << indent << "),\n";
+}
+
 } // namespace _detail_bait_print_static
 
 using _detail_bait_print_static::print_static;
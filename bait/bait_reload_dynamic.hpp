@@ -0,0 +1,349 @@
+#ifndef BEHAVIORTREEPROJ_BAIT_RELOAD_DYNAMIC_HPP
+#define BEHAVIORTREEPROJ_BAIT_RELOAD_DYNAMIC_HPP
+
+#include "bait_dynamic.hpp"
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bait {
+
+template<typename BT, Optimization... Opts>
+struct Reloader;
+
+template<typename... Args, Optimization... Opts>
+struct Reloader<DynamicBT<Args...>, Opts...> {
+    using BT = DynamicBT<Args...>;
+    using Func = typename BT::Func;
+    using Path = std::vector<size_t>;
+
+    // Child access
+
+    template<typename F>
+    static F* child(F& tree, size_t i) {
+        if (auto branch = tree.template target<typename BT::RawSequence>()) {
+            return i < branch->children.size() ? &branch->children[i] : nullptr;
+        } else if (auto branch = tree.template target<typename BT::RawSelector>()) {
+            return i < branch->children.size() ? &branch->children[i] : nullptr;
+        } else if (auto branch = tree.template target<typename BT::RawUtility>()) {
+            return i < branch->children.size() ? &branch->children[i] : nullptr;
+        } else if (auto branch = tree.template target<typename BT::RawParallel>()) {
+            return i < branch->children.size() ? &branch->children[i] : nullptr;
+        } else if (auto branch = tree.template target<typename BT::RawLod>()) {
+            return i < branch->levels.size() ? &branch->levels[i] : nullptr;
+        } else if (auto branch = tree.template target<typename BT::RawInverter>()) {
+            return i == 0 ? &branch->child : nullptr;
+        } else if (auto branch = tree.template target<typename BT::RawUntilFail>()) {
+            return i == 0 ? &branch->child : nullptr;
+        } else if (auto branch = tree.template target<typename BT::RawNamed>()) {
+            return i == 0 ? &branch->child : nullptr;
+        } else if (auto branch = tree.template target<typename BT::RawTraced>()) {
+            return i == 0 ? &branch->child : nullptr;
+        } else if (auto branch = tree.template target<typename BT::RawThreadSafe>()) {
+            return i == 0 ? &branch->child : nullptr;
+        } else {
+            return nullptr;
+        }
+    }
+
+    static bool is_named(const Func& tree, const std::string& name) {
+        auto ptr = tree.template target<typename BT::RawNamed>();
+        return ptr && ptr->name == name;
+    }
+
+    // Lookup
+
+    bool locate(const Func& tree, const std::string& name, Path& path) const {
+        if (is_named(tree, name)) {
+            return true;
+        }
+        for (size_t i = 0; auto c = child(tree, i); ++i) {
+            path.push_back(i);
+            if (locate(*c, name, path)) {
+                return true;
+            }
+            path.pop_back();
+        }
+        return false;
+    }
+
+    Func* follow(Func& tree, const Path& path) const {
+        Func* node = &tree;
+        for (auto i : path) {
+            node = child(*node, i);
+            if (!node) {
+                return nullptr;
+            }
+        }
+        return node;
+    }
+
+    Func* find(Func& tree, const std::string& name, Path& path) const {
+        if (auto node = follow(tree, path)) {
+            if (is_named(*node, name)) {
+                return node;
+            }
+        }
+        path.clear();
+        return locate(tree, name, path) ? follow(tree, path) : nullptr;
+    }
+
+    // Structural equality
+
+    // Leaves are compared by function pointer where they are plain functions and by type otherwise;
+    // composites also compare their parameters and children.
+    template<typename R, typename F>
+    static bool same_leaf(const F& a, const F& b) {
+        using Ptr = R (*)(Args...);
+        if (a.target_type() != b.target_type()) {
+            return false;
+        }
+        auto pa = a.template target<Ptr>();
+        return !pa || *pa == *b.template target<Ptr>();
+    }
+
+    static bool same_node(const Func& a, const Func& b) {
+        if (!same_leaf<status>(a, b)) {
+            return false;
+        }
+        if (auto x = a.template target<typename BT::RawUtility>()) {
+            auto y = b.template target<typename BT::RawUtility>();
+            if (x->hysteresis != y->hysteresis || x->scores.size() != y->scores.size()) {
+                return false;
+            }
+            for (size_t i = 0; i != x->scores.size(); ++i) {
+                if (!same_leaf<float>(x->scores[i], y->scores[i])) {
+                    return false;
+                }
+            }
+        } else if (auto x = a.template target<typename BT::RawParallel>()) {
+            auto y = b.template target<typename BT::RawParallel>();
+            if (x->policy.success_threshold != y->policy.success_threshold || x->policy.pool != y->policy.pool) {
+                return false;
+            }
+        } else if (auto x = a.template target<typename BT::RawNamed>()) {
+            if (x->name != b.template target<typename BT::RawNamed>()->name) {
+                return false;
+            }
+        } else if (auto x = a.template target<typename BT::RawTraced>()) {
+            if (x->id != b.template target<typename BT::RawTraced>()->id) {
+                return false;
+            }
+        } else if (auto x = a.template target<typename BT::RawStateful>()) {
+            return same_leaf<status>(x->child, b.template target<typename BT::RawStateful>()->child);
+        } else if (auto x = a.template target<typename BT::RawStatic>()) {
+            auto y = b.template target<typename BT::RawStatic>();
+            if (x->info != y->info) {
+                return false;
+            }
+            auto xs = slots(x);
+            auto ys = slots(y);
+            for (size_t i = 0; i != xs.size(); ++i) {
+                if (!same_node(*xs[i], *ys[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        size_t i = 0;
+        for (; auto c = child(a, i); ++i) {
+            auto d = child(b, i);
+            if (!d || !same_node(*c, *d)) {
+                return false;
+            }
+        }
+        return !child(b, i);
+    }
+
+    static std::vector<Func*> slots(const typename BT::RawStatic* node) {
+        std::vector<Func*> result;
+        auto gather = [](void* slots, Func& slot) { static_cast<std::vector<Func*>*>(slots)->push_back(&slot); };
+        node->info->slots(const_cast<Func&>(node->child), gather, &result);
+        return result;
+    }
+
+    // State remapping
+
+    // A serial or utility node keeps its position when the children it has already run are unchanged;
+    // a parallel node keeps its results when the children that have finished are unchanged. Anything
+    // else starts over. The running children are then remapped in turn.
+
+    template<status Mode>
+    void remap(const typename BT::template RawSerial<Mode>& from, typename BT::template RawSerial<Mode>& to) const {
+        to.current = 0;
+        if (from.current >= to.children.size()) {
+            return;
+        }
+        for (size_t i = 0; i != from.current; ++i) {
+            if (!same_node(from.children[i], to.children[i])) {
+                return;
+            }
+        }
+        to.current = from.current;
+        remap(from.children[from.current], to.children[to.current]);
+    }
+
+    void remap(const typename BT::RawUtility& from, typename BT::RawUtility& to) const {
+        if (from.current < to.children.size() && from.children.size() == to.children.size()) {
+            to.current = from.current;
+            remap(from.children[from.current], to.children[to.current]);
+        }
+    }
+
+    void remap(const typename BT::RawParallel& from, typename BT::RawParallel& to) const {
+        if (from.children.size() != to.children.size()) {
+            return;
+        }
+        for (size_t i = 0; i != to.children.size(); ++i) {
+            if (from.results[i] != status::RUNNING && !same_node(from.children[i], to.children[i])) {
+                return;
+            }
+        }
+        to.results = from.results;
+        for (size_t i = 0; i != to.children.size(); ++i) {
+            if (from.results[i] == status::RUNNING) {
+                remap(from.children[i], to.children[i]);
+            }
+        }
+    }
+
+    void remap(const Func& from, Func& to) const {
+        if (auto src = from.template target<typename BT::RawSequence>()) {
+            if (auto dst = to.template target<typename BT::RawSequence>()) {
+                remap(*src, *dst);
+            }
+        } else if (auto src = from.template target<typename BT::RawSelector>()) {
+            if (auto dst = to.template target<typename BT::RawSelector>()) {
+                remap(*src, *dst);
+            }
+        } else if (auto src = from.template target<typename BT::RawUtility>()) {
+            if (auto dst = to.template target<typename BT::RawUtility>()) {
+                remap(*src, *dst);
+            }
+        } else if (auto src = from.template target<typename BT::RawParallel>()) {
+            if (auto dst = to.template target<typename BT::RawParallel>()) {
+                remap(*src, *dst);
+            }
+        } else if (auto src = from.template target<typename BT::RawStateful>()) {
+            auto dst = to.template target<typename BT::RawStateful>();
+            if (dst && src->child.target_type() == dst->child.target_type()) {
+                std::memcpy(dst->state(dst->child), src->state(const_cast<Func&>(src->child)), src->size);
+            }
+        } else if (auto src = from.template target<typename BT::RawStatic>()) {
+            auto dst = to.template target<typename BT::RawStatic>();
+            if (dst && src->info == dst->info) {
+                std::vector<unsigned char> state(src->info->size);
+                src->info->save(src->child, state.data());
+                dst->info->restore(dst->child, state.data());
+                auto from_slots = slots(src);
+                auto to_slots = slots(dst);
+                for (size_t i = 0; i != to_slots.size(); ++i) {
+                    remap(*from_slots[i], *to_slots[i]);
+                }
+            }
+        } else if (to.template target<typename BT::RawInverter>() ||
+                   to.template target<typename BT::RawUntilFail>() ||
+                   to.template target<typename BT::RawLod>() ||
+                   to.template target<typename BT::RawNamed>() ||
+                   to.template target<typename BT::RawTraced>() ||
+                   to.template target<typename BT::RawThreadSafe>()) {
+            auto src = child(from, 0);
+            if (src && from.target_type() == to.target_type()) {
+                remap(*src, *child(to, 0));
+            }
+        }
+    }
+
+    // Node reuse
+
+    // Whether child i of `tree` is on its running path.
+    static bool runs(const Func& tree, size_t i) {
+        if (auto n = tree.template target<typename BT::RawSequence>()) {
+            return n->current == i;
+        } else if (auto n = tree.template target<typename BT::RawSelector>()) {
+            return n->current == i;
+        } else if (auto n = tree.template target<typename BT::RawUtility>()) {
+            return n->current == i;
+        } else if (auto n = tree.template target<typename BT::RawParallel>()) {
+            return n->results[i] == status::RUNNING;
+        } else if (tree.template target<typename BT::RawLod>()) {
+            return i == 0;
+        }
+        return true;
+    }
+
+    // Whether remap() carried the running child i of `from` over to `to`.
+    static bool carries(const Func& from, const Func& to, size_t i) {
+        if (auto n = from.template target<typename BT::RawParallel>()) {
+            auto m = to.template target<typename BT::RawParallel>();
+            return n->results[i] == status::RUNNING && n->results == m->results;
+        }
+        return runs(from, i) && runs(to, i);
+    }
+
+    // Moves every subtree of `from` that is unchanged in `to` over in place of its fresh copy, together
+    // with its state. `running` tells whether `from` was on the running path and `kept` whether remap()
+    // carried its state over; subtrees that were running but start over are reset first.
+    void reuse(Func& from, Func& to, bool running, bool kept) const {
+        if (same_node(from, to)) {
+            if (running && !kept) {
+                BT::reset(from);
+            }
+            to = std::move(from);
+            return;
+        }
+        if (from.target_type() != to.target_type()) {
+            return;
+        }
+        for (size_t i = 0; auto c = child(to, i); ++i) {
+            auto old = child(from, i);
+            if (!old) {
+                break;
+            }
+            bool child_running = running && runs(from, i);
+            reuse(*old, *c, child_running, kept && child_running && carries(from, to, i));
+        }
+    }
+
+    // Swapping
+    //
+    // The replacement is simplified once and copied into every tree. Running state carries over
+    // through remap(), and reuse() then keeps the old nodes wherever the replacement is unchanged.
+
+    bool swap(Func& tree, const std::string& name, Func replacement) const {
+        Path path;
+        return swap(tree, name, Simplifier<BT, Opts...>()(std::move(replacement)), path);
+    }
+
+    template<typename Iter>
+    size_t swap(Iter first, Iter last, const std::string& name, Func replacement) const {
+        auto simplified = Simplifier<BT, Opts...>()(std::move(replacement));
+        Path path;
+        size_t count = 0;
+        for (; first != last; ++first) {
+            if (swap(*first, name, simplified, path)) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+private:
+    bool swap(Func& tree, const std::string& name, Func replacement, Path& path) const {
+        auto node = find(tree, name, path);
+        if (!node) {
+            return false;
+        }
+        auto& old = node->template target<typename BT::RawNamed>()->child;
+        remap(old, replacement);
+        reuse(old, replacement, true, true);
+        old = std::move(replacement);
+        return true;
+    }
+};
+
+} // namespace bait
+
+#endif //BEHAVIORTREEPROJ_BAIT_RELOAD_DYNAMIC_HPP
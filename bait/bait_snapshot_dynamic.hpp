@@ -0,0 +1,100 @@
+#ifndef BEHAVIORTREEPROJ_BAIT_SNAPSHOT_DYNAMIC_HPP
+#define BEHAVIORTREEPROJ_BAIT_SNAPSHOT_DYNAMIC_HPP
+
+#include "bait_dynamic.hpp"
+#include "bait_reload_dynamic.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace bait {
+
+template<typename BT>
+struct StateMap;
+
+// Locations of all mutable tick state in one tree: the `current` index of serial and utility nodes,
+// the child results of parallel nodes, the snapshot_state() of stateful leaves and the state of
+// embedded StaticBT trees, including the dynamic slots inside them. Built once per tree, it saves
+// and restores that state as a flat byte buffer of size() bytes. It refers into the tree, so rebuild
+// it after the tree is modified or moved into a different Func.
+template<typename... Args>
+struct StateMap<DynamicBT<Args...>> {
+    using BT = DynamicBT<Args...>;
+    using Func = typename BT::Func;
+
+    // Embedded StaticBT trees are copied through their `info`, everything else with memcpy.
+    struct Region {
+        void* data;
+        size_t size;
+        const typename BT::StaticInfo* info;
+    };
+
+    std::vector<Region> regions;
+    size_t bytes = 0;
+
+    explicit StateMap(Func& tree) {
+        collect(tree);
+    }
+
+    void add(void* data, size_t size, const typename BT::StaticInfo* info = nullptr) {
+        regions.push_back({data, size, info});
+        bytes += size;
+    }
+
+    void collect(Func& tree) {
+        if (auto ptr = tree.template target<typename BT::RawSequence>()) {
+            add(&ptr->current, sizeof(ptr->current));
+        } else if (auto ptr = tree.template target<typename BT::RawSelector>()) {
+            add(&ptr->current, sizeof(ptr->current));
+        } else if (auto ptr = tree.template target<typename BT::RawUtility>()) {
+            add(&ptr->current, sizeof(ptr->current));
+        } else if (auto ptr = tree.template target<typename BT::RawParallel>()) {
+            add(ptr->results.data(), ptr->results.size() * sizeof(status));
+        } else if (auto ptr = tree.template target<typename BT::RawStateful>()) {
+            add(ptr->state(ptr->child), ptr->size);
+        } else if (auto ptr = tree.template target<typename BT::RawStatic>()) {
+            add(&ptr->child, ptr->info->size, ptr->info);
+            ptr->info->slots(ptr->child, [](void* map, Func& slot) { static_cast<StateMap*>(map)->collect(slot); },
+                             this);
+        }
+        for (size_t i = 0; auto c = Reloader<BT>::child(tree, i); ++i) {
+            collect(*c);
+        }
+    }
+
+    size_t size() const {
+        return bytes;
+    }
+
+    void save(unsigned char* out) const {
+        for (auto& r : regions) {
+            if (r.info) {
+                r.info->save(*static_cast<const Func*>(r.data), out);
+            } else {
+                std::memcpy(out, r.data, r.size);
+            }
+            out += r.size;
+        }
+    }
+
+    void restore(const unsigned char* in) const {
+        for (auto& r : regions) {
+            if (r.info) {
+                r.info->restore(*static_cast<Func*>(r.data), in);
+            } else {
+                std::memcpy(r.data, in, r.size);
+            }
+            in += r.size;
+        }
+    }
+
+    std::vector<unsigned char> save() const {
+        std::vector<unsigned char> buffer(bytes);
+        save(buffer.data());
+        return buffer;
+    }
+};
+
+} // namespace bait
+
+#endif //BEHAVIORTREEPROJ_BAIT_SNAPSHOT_DYNAMIC_HPP
@@ -0,0 +1,302 @@
+#ifndef BEHAVIORTREEPROJ_BAIT_SNAPSHOT_STATIC_HPP
+#define BEHAVIORTREEPROJ_BAIT_SNAPSHOT_STATIC_HPP
+
+#include "bait_static.hpp"
+
+#include <array>
+#include <cstring>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+
+namespace bait {
+
+namespace _detail_bait_snapshot_static {
+
+using namespace std;
+
+template<typename...>
+struct voider {
+    using type = void;
+};
+
+// Tick state of a node type: its size in bytes and how to copy it to and from a flat buffer.
+// Leaves and decorators opt in by exposing trivially copyable state through snapshot_state().
+// Dynamic slots have no fixed size; they are only reported through has_slots and visit_slots().
+template<typename T, typename = void>
+struct state {
+    static constexpr size_t size = 0;
+    static constexpr bool has_slots = false;
+
+    static void save(const T&, unsigned char*) { }
+
+    static void restore(T&, const unsigned char*) { }
+
+    template<typename F>
+    static void visit_slots(T&, F&&) { }
+};
+
+template<typename T>
+struct state<T, typename voider<decltype(declval<T&>().snapshot_state())>::type> {
+    using State = remove_reference_t<decltype(declval<T&>().snapshot_state())>;
+    static_assert(is_trivially_copyable<State>::value, "snapshot_state() must be trivially copyable");
+
+    static constexpr size_t size = sizeof(State);
+    static constexpr bool has_slots = false;
+
+    static void save(const T& t, unsigned char* out) {
+        memcpy(out, &const_cast<T&>(t).snapshot_state(), size);
+    }
+
+    static void restore(T& t, const unsigned char* in) {
+        memcpy(&t.snapshot_state(), in, size);
+    }
+
+    template<typename F>
+    static void visit_slots(T&, F&&) { }
+};
+
+template<typename... Ts>
+struct tuple_state {
+    template<size_t I>
+    static constexpr size_t offset() {
+        const size_t sizes[] = {0, state<Ts>::size...};
+        size_t total = 0;
+        for (size_t i = 0; i != I; ++i) {
+            total += sizes[i + 1];
+        }
+        return total;
+    }
+
+    static constexpr size_t size = offset<sizeof...(Ts)>();
+
+    static constexpr bool any_slots() {
+        const bool flags[] = {false, state<Ts>::has_slots...};
+        for (auto f : flags) {
+            if (f) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static constexpr bool has_slots = any_slots();
+
+    template<size_t... Is>
+    static void save(const tuple<Ts...>& tup, unsigned char* out, integer_sequence<size_t, Is...>) {
+        using intarr = int[sizeof...(Ts) + 1];
+        (void) intarr{0, (state<Ts>::save(get<Is>(tup), out + offset<Is>()), 0)...};
+    }
+
+    template<size_t... Is>
+    static void restore(tuple<Ts...>& tup, const unsigned char* in, integer_sequence<size_t, Is...>) {
+        using intarr = int[sizeof...(Ts) + 1];
+        (void) intarr{0, (state<Ts>::restore(get<Is>(tup), in + offset<Is>()), 0)...};
+    }
+
+    static void save(const tuple<Ts...>& tup, unsigned char* out) {
+        save(tup, out, make_integer_sequence<size_t, sizeof...(Ts)>());
+    }
+
+    static void restore(tuple<Ts...>& tup, const unsigned char* in) {
+        restore(tup, in, make_integer_sequence<size_t, sizeof...(Ts)>());
+    }
+
+    template<typename F, size_t... Is>
+    static void visit_slots(tuple<Ts...>& tup, F& f, integer_sequence<size_t, Is...>) {
+        using intarr = int[sizeof...(Ts) + 1];
+        (void) intarr{0, (state<Ts>::visit_slots(get<Is>(tup), f), 0)...};
+    }
+
+    template<typename F>
+    static void visit_slots(tuple<Ts...>& tup, F&& f) {
+        visit_slots(tup, f, make_integer_sequence<size_t, sizeof...(Ts)>());
+    }
+};
+
+// Nodes with a `current` index followed by their children's state
+template<typename T, typename... Ts>
+struct indexed_state {
+    static constexpr size_t size = sizeof(size_t) + tuple_state<Ts...>::size;
+    static constexpr bool has_slots = tuple_state<Ts...>::has_slots;
+
+    static void save(const T& t, unsigned char* out) {
+        memcpy(out, &t.current, sizeof(size_t));
+        tuple_state<Ts...>::save(t.value, out + sizeof(size_t));
+    }
+
+    static void restore(T& t, const unsigned char* in) {
+        memcpy(&t.current, in, sizeof(size_t));
+        tuple_state<Ts...>::restore(t.value, in + sizeof(size_t));
+    }
+
+    template<typename F>
+    static void visit_slots(T& t, F&& f) {
+        tuple_state<Ts...>::visit_slots(t.value, f);
+    }
+};
+
+template<status Mode, typename... Ts>
+struct state<StaticBT::sequence_t<Mode, Ts...>> : indexed_state<StaticBT::sequence_t<Mode, Ts...>, Ts...> {
+};
+
+template<status Mode>
+struct state<StaticBT::sequence_t<Mode>> {
+    static constexpr size_t size = 0;
+    static constexpr bool has_slots = false;
+
+    static void save(const StaticBT::sequence_t<Mode>&, unsigned char*) { }
+
+    static void restore(StaticBT::sequence_t<Mode>&, const unsigned char*) { }
+
+    template<typename F>
+    static void visit_slots(StaticBT::sequence_t<Mode>&, F&&) { }
+};
+
+template<typename... Os>
+struct state<StaticBT::utility_t<Os...>> : indexed_state<StaticBT::utility_t<Os...>, Os...> {
+};
+
+template<typename S, typename T>
+struct state<StaticBT::option_t<S, T>> {
+    static constexpr size_t size = state<T>::size;
+    static constexpr bool has_slots = state<T>::has_slots;
+
+    static void save(const StaticBT::option_t<S, T>& o, unsigned char* out) {
+        state<T>::save(o.child, out);
+    }
+
+    static void restore(StaticBT::option_t<S, T>& o, const unsigned char* in) {
+        state<T>::restore(o.child, in);
+    }
+
+    template<typename F>
+    static void visit_slots(StaticBT::option_t<S, T>& o, F&& f) {
+        state<T>::visit_slots(o.child, f);
+    }
+};
+
+// Nodes without state of their own
+template<typename T, typename Value>
+struct wrapper_state {
+    static constexpr size_t size = state<Value>::size;
+    static constexpr bool has_slots = state<Value>::has_slots;
+
+    static void save(const T& t, unsigned char* out) {
+        state<Value>::save(t.value, out);
+    }
+
+    static void restore(T& t, const unsigned char* in) {
+        state<Value>::restore(t.value, in);
+    }
+
+    template<typename F>
+    static void visit_slots(T& t, F&& f) {
+        state<Value>::visit_slots(t.value, f);
+    }
+};
+
+template<typename T>
+struct state<StaticBT::inverter_t<T>> : wrapper_state<StaticBT::inverter_t<T>, T> {
+};
+
+template<typename T>
+struct state<StaticBT::until_fail_t<T>> : wrapper_state<StaticBT::until_fail_t<T>, T> {
+};
+
+template<typename T>
+struct state<StaticBT::thread_safe_t<T>> : wrapper_state<StaticBT::thread_safe_t<T>, T> {
+};
+
+template<typename... Ts>
+struct state<StaticBT::parallel_t<Ts...>> {
+    using T = StaticBT::parallel_t<Ts...>;
+    static constexpr size_t results_size = sizeof(status) * sizeof...(Ts);
+    static constexpr size_t size = results_size + tuple_state<Ts...>::size;
+    static constexpr bool has_slots = tuple_state<Ts...>::has_slots;
+
+    static void save(const T& t, unsigned char* out) {
+        memcpy(out, t.results.data(), results_size);
+        tuple_state<Ts...>::save(t.value, out + results_size);
+    }
+
+    static void restore(T& t, const unsigned char* in) {
+        memcpy(t.results.data(), in, results_size);
+        tuple_state<Ts...>::restore(t.value, in + results_size);
+    }
+
+    template<typename F>
+    static void visit_slots(T& t, F&& f) {
+        tuple_state<Ts...>::visit_slots(t.value, f);
+    }
+};
+
+template<typename... Ts>
+struct state<StaticBT::lod_t<Ts...>> : wrapper_state<StaticBT::lod_t<Ts...>, tuple<Ts...>> {
+};
+
+template<typename BT>
+struct state<StaticBT::dynamic_t<BT>> {
+    static constexpr size_t size = 0;
+    static constexpr bool has_slots = true;
+
+    static void save(const StaticBT::dynamic_t<BT>&, unsigned char*) { }
+
+    static void restore(StaticBT::dynamic_t<BT>&, const unsigned char*) { }
+
+    template<typename F>
+    static void visit_slots(StaticBT::dynamic_t<BT>& dyn, F&& f) {
+        f(dyn.value);
+    }
+};
+
+template<typename... Ts>
+struct state<tuple<Ts...>> : tuple_state<Ts...> {
+};
+
+template<typename T>
+constexpr size_t state_size() {
+    static_assert(!state<T>::has_slots, "tree holds a dynamic slot, whose state has no fixed size; "
+                                        "embed it in a DynamicBT tree and use StateMap");
+    return state<T>::size;
+}
+
+template<typename T>
+using snapshot_t = array<unsigned char, state_size<T>()>;
+
+template<typename T>
+void save_state(const T& tree, unsigned char* out) {
+    (void) state_size<T>();
+    state<T>::save(tree, out);
+}
+
+template<typename T>
+void restore_state(T& tree, const unsigned char* in) {
+    (void) state_size<T>();
+    state<T>::restore(tree, in);
+}
+
+template<typename T>
+snapshot_t<T> snapshot(const T& tree) {
+    snapshot_t<T> buffer;
+    state<T>::save(tree, buffer.data());
+    return buffer;
+}
+
+template<typename T>
+void restore(T& tree, const snapshot_t<T>& buffer) {
+    state<T>::restore(tree, buffer.data());
+}
+
+} // namespace _detail_bait_snapshot_static
+
+using _detail_bait_snapshot_static::state_size;
+using _detail_bait_snapshot_static::snapshot_t;
+using _detail_bait_snapshot_static::save_state;
+using _detail_bait_snapshot_static::restore_state;
+using _detail_bait_snapshot_static::snapshot;
+using _detail_bait_snapshot_static::restore;
+
+} // namespace bait
+
+#endif //BEHAVIORTREEPROJ_BAIT_SNAPSHOT_STATIC_HPP
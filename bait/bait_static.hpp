@@ -3,6 +3,7 @@
 
 #include "bait_common.hpp"
 
+#include <array>
 #include <tuple>
 #include <utility>
 #include <type_traits>
@@ -110,6 +111,135 @@ struct StaticBT {
         }
     };
 
+    template<typename S, typename T>
+    struct option_t {
+        S score;
+        T child;
+    };
+
+    template<typename... Os>
+    struct utility_t : EBCO<tuple<Os...>> {
+        static_assert(sizeof...(Os) > 0, "utility requires at least one option");
+
+        float hysteresis;
+        size_t current = size_t(-1);
+
+        constexpr utility_t(tuple<Os...> options, float hysteresis) : EBCO<tuple<Os...>>{move(options)},
+                                                                     hysteresis(hysteresis) { }
+
+        template<size_t... Is, typename... Args>
+        void score(float* scores, integer_sequence<size_t, Is...>, Args&& ... args) {
+            using intarr = int[sizeof...(Os)];
+            (void) intarr{(scores[Is] = get<Is>(EBCO<tuple<Os...>>::value).score(forward<Args>(args)...), 0)...};
+        }
+
+        template<typename... Args>
+        status operator()(Args&& ... args) {
+            float scores[sizeof...(Os)];
+            score(scores, make_integer_sequence<size_t, sizeof...(Os)>(), args...);
+            auto best = best_utility(scores, sizeof...(Os), current, hysteresis);
+            if (current < sizeof...(Os) && best != current) {
+                apply(current, EBCO<tuple<Os...>>::value, [](auto&& o) { reset(o.child); return status::RUNNING; });
+            }
+            current = best;
+            return apply(current, EBCO<tuple<Os...>>::value,
+                         [&](auto&& o) { return o.child(forward<Args>(args)...); });
+        }
+    };
+
+    // Marks a subtree as safe to tick concurrently with its siblings in a parallel node.
+    template<typename T>
+    struct thread_safe_t : EBCO<T> {
+        constexpr thread_safe_t(T t) : EBCO<T>(move(t)) { }
+
+        template<typename... Args>
+        status operator()(Args&& ... args) {
+            return EBCO<T>::value(forward<Args>(args)...);
+        }
+    };
+
+    template<typename T>
+    struct is_thread_safe : false_type {
+    };
+
+    template<typename T>
+    struct is_thread_safe<thread_safe_t<T>> : true_type {
+    };
+
+    template<typename... Ts>
+    struct parallel_t : EBCO<tuple<Ts...>> {
+        ParallelPolicy policy;
+        array<status, sizeof...(Ts)> results;
+
+        parallel_t(tuple<Ts...> children, ParallelPolicy policy) : EBCO<tuple<Ts...>>{move(children)},
+                                                                   policy(policy) {
+            results.fill(status::RUNNING);
+        }
+
+        template<size_t... Is, typename... Args>
+        size_t tick_inline(integer_sequence<size_t, Is...>, size_t* pending, Args&& ... args) {
+            size_t count = 0;
+            auto tick = [&](size_t i, bool pooled, auto& child) {
+                if (results[i] == status::RUNNING) {
+                    if (pooled && policy.pool) {
+                        pending[count++] = i;
+                    } else {
+                        results[i] = child(args...);
+                    }
+                }
+                return 0;
+            };
+            using intarr = int[sizeof...(Ts) + 1];
+            (void) intarr{0, tick(Is, is_thread_safe<Ts>::value, get<Is>(EBCO<tuple<Ts...>>::value))...};
+            return count;
+        }
+
+        template<typename... Args>
+        status operator()(Args&& ... args) {
+            // Every child sees the same arguments, and pooled children read them concurrently, so they are
+            // passed as lvalues that no child can move from.
+            size_t pending[sizeof...(Ts) + 1];
+            auto count = tick_inline(make_integer_sequence<size_t, sizeof...(Ts)>(), pending, args...);
+            auto job = [&](size_t k) {
+                results[pending[k]] = apply(pending[k], EBCO<tuple<Ts...>>::value,
+                                            [&](auto&& child) { return child(args...); });
+            };
+            if (count == 1) {
+                job(0);
+            } else if (count > 1) {
+                policy.pool->run(count, run_job<decltype(job)>, &job);
+            }
+            auto result = parallel_result(results.data(), sizeof...(Ts), policy.required(sizeof...(Ts)));
+            if (result != status::RUNNING) {
+                reset(*this);
+            }
+            return result;
+        }
+    };
+
+    template<typename... Ts>
+    struct lod_t : EBCO<tuple<Ts...>> {
+        constexpr lod_t(tuple<Ts...> levels) : EBCO<tuple<Ts...>>{move(levels)} { }
+
+        template<typename... Args>
+        status operator()(Args&& ... args) {
+            return get<0>(EBCO<tuple<Ts...>>::value)(forward<Args>(args)...);
+        }
+    };
+
+    // Slot for a subtree of the runtime-built tree type BT, such as DynamicBT<Args...>. Simplifying the
+    // static tree also simplifies the slot with Simplifier<BT, Optimization::ALL>. The slot's own tick
+    // state is not part of static snapshots.
+    template<typename BT>
+    struct dynamic_t : EBCO<typename BT::Func> {
+        dynamic_t(typename BT::Func f) : EBCO<typename BT::Func>(move(f)) { }
+
+        template<typename... Args>
+        status operator()(Args&& ... args) {
+            return EBCO<typename BT::Func>::value(forward<Args>(args)...);
+        }
+    };
+
     template<typename... Ts>
     static constexpr auto sequence(Ts... ts) {
         return sequence_t<status::SUCCESS, Ts...>(make_tuple(move(ts)...));
@@ -145,6 +275,36 @@ struct StaticBT {
         return until_fail_t<T>(t);
     }
 
+    template<typename S, typename T>
+    static constexpr auto option(S score, T t) {
+        return option_t<S, T>{move(score), move(t)};
+    }
+
+    template<typename... Os>
+    static constexpr auto utility(float hysteresis, Os... os) {
+        return utility_t<Os...>(make_tuple(move(os)...), hysteresis);
+    }
+
+    template<typename T, typename... Ts>
+    static auto parallel(ParallelPolicy policy, T t, Ts... ts) {
+        return parallel_t<T, Ts...>(make_tuple(move(t), move(ts)...), policy);
+    }
+
+    template<typename T>
+    static constexpr auto thread_safe(T t) {
+        return thread_safe_t<T>(move(t));
+    }
+
+    template<typename T, typename... Ts>
+    static constexpr auto lod(T t, Ts... ts) {
+        return lod_t<T, Ts...>(make_tuple(move(t), move(ts)...));
+    }
+
+    template<typename BT>
+    static auto dynamic(typename BT::Func f) {
+        return dynamic_t<BT>(move(f));
+    }
+
     static constexpr auto succeed() { return sequence(); }
 
     static constexpr auto fail() { return selector(); }
@@ -184,6 +344,130 @@ struct StaticBT {
         return sequence_t<Mode, T, U>(make_tuple(move(s1), move(s2)));
     }
 
+    // Replaces every lod node with its variant for level L; the last variant covers all higher levels.
+
+    template<size_t L, typename T>
+    static auto reduce_lod(T t) {
+        return t;
+    }
+
+    template<size_t L, status Mode, typename... Ts, size_t... Is>
+    static auto _reduce_lod_impl(sequence_t<Mode, Ts...> seq, integer_sequence<size_t, Is...>) {
+        return sequence_t<Mode, decltype(reduce_lod<L>(declval<Ts>()))...>(
+                make_tuple(reduce_lod<L>(move(get<Is>(seq.value)))...));
+    }
+
+    template<size_t L, status Mode, typename... Ts>
+    static auto reduce_lod(sequence_t<Mode, Ts...> seq) {
+        return _reduce_lod_impl<L>(move(seq), make_integer_sequence<size_t, sizeof...(Ts)>());
+    }
+
+    template<size_t L, status Mode>
+    static auto reduce_lod(sequence_t<Mode> seq) {
+        return seq;
+    }
+
+    template<size_t L, typename T>
+    static auto reduce_lod(inverter_t<T> inv) {
+        return inverter_t<decltype(reduce_lod<L>(declval<T>()))>(reduce_lod<L>(move(inv.value)));
+    }
+
+    template<size_t L, typename T>
+    static auto reduce_lod(until_fail_t<T> uf) {
+        return until_fail_t<decltype(reduce_lod<L>(declval<T>()))>(reduce_lod<L>(move(uf.value)));
+    }
+
+    template<size_t L, typename... Ss, typename... Ts, size_t... Is>
+    static auto _reduce_lod_impl(utility_t<option_t<Ss, Ts>...> ut, integer_sequence<size_t, Is...>) {
+        return utility(ut.hysteresis, option(move(get<Is>(ut.value).score),
+                                             reduce_lod<L>(move(get<Is>(ut.value).child)))...);
+    }
+
+    template<size_t L, typename... Ss, typename... Ts>
+    static auto reduce_lod(utility_t<option_t<Ss, Ts>...> ut) {
+        return _reduce_lod_impl<L>(move(ut), make_integer_sequence<size_t, sizeof...(Ts)>());
+    }
+
+    template<size_t L, typename... Ts, size_t... Is>
+    static auto _reduce_lod_impl(parallel_t<Ts...> par, integer_sequence<size_t, Is...>) {
+        return parallel(par.policy, reduce_lod<L>(move(get<Is>(par.value)))...);
+    }
+
+    template<size_t L, typename... Ts>
+    static auto reduce_lod(parallel_t<Ts...> par) {
+        return _reduce_lod_impl<L>(move(par), make_integer_sequence<size_t, sizeof...(Ts)>());
+    }
+
+    template<size_t L, typename T>
+    static auto reduce_lod(thread_safe_t<T> ts) {
+        return thread_safe(reduce_lod<L>(move(ts.value)));
+    }
+
+    template<size_t L, typename... Ts>
+    static auto reduce_lod(lod_t<Ts...> lod) {
+        constexpr size_t level = L < sizeof...(Ts) ? L : sizeof...(Ts) - 1;
+        return reduce_lod<L>(move(get<level>(lod.value)));
+    }
+
+    // Returns a subtree that was left RUNNING to its initial state, following only its running path.
+
+    template<typename T>
+    static void reset(T&) { }
+
+    template<status Mode>
+    static void reset(sequence_t<Mode>&) { }
+
+    template<status Mode, typename... Ts>
+    static void reset(sequence_t<Mode, Ts...>& seq) {
+        if (seq.current < sizeof...(Ts)) {
+            apply(seq.current, seq.value, [](auto&& child) { reset(child); return status::RUNNING; });
+        }
+        seq.current = 0;
+    }
+
+    template<typename T>
+    static void reset(inverter_t<T>& inv) {
+        reset(inv.value);
+    }
+
+    template<typename T>
+    static void reset(until_fail_t<T>& uf) {
+        reset(uf.value);
+    }
+
+    template<typename... Os>
+    static void reset(utility_t<Os...>& ut) {
+        if (ut.current < sizeof...(Os)) {
+            apply(ut.current, ut.value, [](auto&& o) { reset(o.child); return status::RUNNING; });
+        }
+        ut.current = size_t(-1);
+    }
+
+    template<typename... Ts>
+    static void reset(parallel_t<Ts...>& par) {
+        for (size_t i = 0; i != sizeof...(Ts); ++i) {
+            if (par.results[i] == status::RUNNING) {
+                apply(i, par.value, [](auto&& child) { reset(child); return status::RUNNING; });
+            }
+            par.results[i] = status::RUNNING;
+        }
+    }
+
+    template<typename T>
+    static void reset(thread_safe_t<T>& ts) {
+        reset(ts.value);
+    }
+
+    template<typename... Ts>
+    static void reset(lod_t<Ts...>& lod) {
+        reset(get<0>(lod.value));
+    }
+
+    template<typename BT>
+    static void reset(dynamic_t<BT>& dyn) {
+        BT::reset(dyn.value);
+    }
+
     template<typename T>
     static auto simplify(T t) {
         return t;
@@ -205,6 +489,43 @@ struct StaticBT {
     static auto simplify(sequence_t<Mode, T> seq) {
         return simplify(tuple_head(move(seq.value)));
     }
+
+    template<typename... Ss, typename... Ts, size_t... Is>
+    static auto _simplify_utility_impl(utility_t<option_t<Ss, Ts>...> ut, integer_sequence<size_t, Is...>) {
+        return utility(ut.hysteresis, option(move(get<Is>(ut.value).score),
+                                             simplify(move(get<Is>(ut.value).child)))...);
+    }
+
+    template<typename... Ss, typename... Ts>
+    static auto simplify(utility_t<option_t<Ss, Ts>...> ut) {
+        return _simplify_utility_impl(move(ut), make_integer_sequence<size_t, sizeof...(Ts)>());
+    }
+
+    template<typename S, typename T>
+    static auto simplify(utility_t<option_t<S, T>> ut) {
+        return simplify(move(get<0>(ut.value).child));
+    }
+
+    // The policy is only known at run time, so parallel children are simplified but never unwrapped.
+    template<typename... Ts, size_t... Is>
+    static auto _simplify_parallel_impl(parallel_t<Ts...> par, integer_sequence<size_t, Is...>) {
+        return parallel(par.policy, simplify(move(get<Is>(par.value)))...);
+    }
+
+    template<typename... Ts>
+    static auto simplify(parallel_t<Ts...> par) {
+        return _simplify_parallel_impl(move(par), make_integer_sequence<size_t, sizeof...(Ts)>());
+    }
+
+    template<typename T>
+    static auto simplify(thread_safe_t<T> ts) {
+        return thread_safe(simplify(move(ts.value)));
+    }
+
+    template<typename BT>
+    static auto simplify(dynamic_t<BT> dyn) {
+        return dynamic<BT>(Simplifier<BT, Optimization::ALL>()(move(dyn.value)));
+    }
 };
 
 } // namespace _detail_bait_static
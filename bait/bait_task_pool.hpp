@@ -0,0 +1,151 @@
+#ifndef BEHAVIORTREEPROJ_BAIT_TASK_POOL_HPP
+#define BEHAVIORTREEPROJ_BAIT_TASK_POOL_HPP
+
+#include "bait_common.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bait {
+
+namespace _detail_bait_task_pool {
+
+using namespace std;
+
+// Fixed set of worker threads that run one batch at a time, with the calling thread helping out.
+// A batch started while another is running (for example by a parallel node nested inside a pooled
+// child) runs inline on the calling thread instead.
+struct ThreadPool : TaskPool {
+    // Marks the pools whose batch the current thread is running, innermost first, so that a nested
+    // batch on the same pool is detected without locking batch_mutex twice.
+    struct BatchMark {
+        const ThreadPool* pool;
+        BatchMark* outer;
+
+        explicit BatchMark(const ThreadPool* pool) : pool(pool), outer(top()) {
+            top() = this;
+        }
+
+        ~BatchMark() {
+            top() = outer;
+        }
+
+        static BatchMark*& top() {
+            static thread_local BatchMark* mark = nullptr;
+            return mark;
+        }
+    };
+
+    mutex batch_mutex;
+    mutex m;
+    condition_variable start;
+    condition_variable finish;
+    vector<thread> workers;
+    uint64_t generation = 0;
+    size_t active = 0;
+    bool stopping = false;
+
+    void (* job)(void*, size_t) = nullptr;
+    void* ctx = nullptr;
+    size_t count = 0;
+    atomic<size_t> next{0};
+    atomic<size_t> done{0};
+
+    explicit ThreadPool(size_t threads = thread::hardware_concurrency() > 1 ? thread::hardware_concurrency() - 1 : 1) {
+        workers.reserve(threads);
+        for (size_t i = 0; i != threads; ++i) {
+            workers.emplace_back([this] { work_loop(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(m);
+            stopping = true;
+        }
+        start.notify_all();
+        for (auto& w : workers) {
+            w.join();
+        }
+    }
+
+    void work() {
+        for (size_t i; (i = next.fetch_add(1, memory_order_relaxed)) < count;) {
+            job(ctx, i);
+            done.fetch_add(1, memory_order_release);
+        }
+    }
+
+    void work_loop() {
+        uint64_t seen = 0;
+        unique_lock<mutex> lock(m);
+        while (true) {
+            start.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            ++active;
+            lock.unlock();
+            work();
+            lock.lock();
+            if (--active == 0) {
+                finish.notify_all();
+            }
+        }
+    }
+
+    bool in_batch() const {
+        for (auto mark = BatchMark::top(); mark; mark = mark->outer) {
+            if (mark->pool == this) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void run(size_t n, void (* fn)(void*, size_t), void* c) override {
+        unique_lock<mutex> batch;
+        if (!workers.empty() && !in_batch()) {
+            batch = unique_lock<mutex>(batch_mutex, try_to_lock);
+        }
+        if (!batch.owns_lock()) {
+            for (size_t i = 0; i != n; ++i) {
+                fn(c, i);
+            }
+            return;
+        }
+        BatchMark mark(this);
+        {
+            // Workers still leaving the previous batch must not see this one's fields change
+            unique_lock<mutex> lock(m);
+            finish.wait(lock, [&] { return active == 0; });
+            job = fn;
+            ctx = c;
+            count = n;
+            next.store(0, memory_order_relaxed);
+            done.store(0, memory_order_relaxed);
+            ++generation;
+        }
+        start.notify_all();
+        work();
+        unique_lock<mutex> lock(m);
+        finish.wait(lock, [&] { return active == 0 && done.load(memory_order_acquire) == count; });
+    }
+};
+
+} // namespace _detail_bait_task_pool
+
+using _detail_bait_task_pool::ThreadPool;
+
+} // namespace bait
+
+#endif //BEHAVIORTREEPROJ_BAIT_TASK_POOL_HPP
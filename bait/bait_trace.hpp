@@ -0,0 +1,423 @@
+#ifndef BEHAVIORTREEPROJ_BAIT_TRACE_HPP
+#define BEHAVIORTREEPROJ_BAIT_TRACE_HPP
+
+#include "bait_common.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace bait {
+
+namespace _detail_bait_trace {
+
+using namespace std;
+
+// Log layout: a sequence of frames [varint writer][varint size][size bytes]. Concatenating the frames
+// of one writer gives its record stream. Every record starts with a varint head whose low two bits
+// hold a status, or 3 for a control record whose kind is head >> 2.
+//
+//     event:       head = zigzag(node - previous node) << 2 | status
+//                  varint ns since the previous record
+//     TICK_BEGIN:  varint agent, varint tick
+//                  varint ns since the previous TICK_BEGIN (or since the sink was created)
+//     TICK_BEGIN_UNTIMED: as TICK_BEGIN, but the events of the tick carry no time
+//
+// Node numbers restart from 0 at every TICK_BEGIN. Reading the clock costs more than the rest of an
+// event, so writers can be set to only time whole ticks.
+
+enum class record {
+    TICK_BEGIN,
+    TICK_BEGIN_UNTIMED
+};
+
+constexpr uint64_t control_bits = 3;
+
+inline uint64_t zigzag(int64_t v) {
+    return (uint64_t(v) << 1) ^ uint64_t(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t v) {
+    return int64_t(v >> 1) ^ -int64_t(v & 1);
+}
+
+template<typename Out>
+void put_varint(Out&& put, uint64_t v) {
+    while (v >= 0x80) {
+        put((unsigned char) (v | 0x80));
+        v >>= 7;
+    }
+    put((unsigned char) v);
+}
+
+using trace_clock = chrono::steady_clock;
+
+// Events recorded on a pool thread while it ticks one child of a parallel node. They are held until
+// the thread that ticks the node appends them to its own writer, or to its own stage when it is a
+// pool thread itself.
+struct TraceStage {
+    struct Entry {
+        uint32_t node;
+        status result;
+        trace_clock::time_point time;
+    };
+
+    vector<Entry> entries;
+    bool timed = true;
+
+    static TraceStage*& active() {
+        static thread_local TraceStage* stage = nullptr;
+        return stage;
+    }
+
+    void event(uint32_t node, status s) {
+        entries.push_back({node, s, timed ? trace_clock::now() : trace_clock::time_point()});
+    }
+
+    void append(const TraceStage& stage) {
+        entries.insert(entries.end(), stage.entries.begin(), stage.entries.end());
+    }
+};
+
+// Single-producer single-consumer byte ring. The owning thread records events; the sink's flusher
+// thread drains them. Nothing becomes visible to the flusher until end_tick() or until the ring
+// runs out of space.
+struct TraceWriter {
+    vector<unsigned char> ring;
+    size_t mask;
+    atomic<size_t> head{0};
+    atomic<size_t> tail{0};
+    size_t local_tail = 0;
+    size_t cached_head = 0;
+    bool timed = true;
+    uint32_t last_node = 0;
+    trace_clock::time_point last_event;
+    trace_clock::time_point last_tick;
+
+    TraceWriter(trace_clock::time_point epoch, size_t capacity_log2 = 20)
+            : ring(size_t(1) << capacity_log2), mask(ring.size() - 1), last_tick(epoch) { }
+
+    static TraceWriter*& active() {
+        static thread_local TraceWriter* writer = nullptr;
+        return writer;
+    }
+
+    void reserve(size_t n) {
+        // Only touch the consumer's cache line when the cached view says the ring is full.
+        while (ring.size() - (local_tail - cached_head) < n) {
+            tail.store(local_tail, memory_order_release);
+            cached_head = head.load(memory_order_acquire);
+            if (ring.size() - (local_tail - cached_head) < n) {
+                this_thread::yield();
+            }
+        }
+    }
+
+    void put(unsigned char b) {
+        ring[local_tail++ & mask] = b;
+    }
+
+    void varint(uint64_t v) {
+        put_varint([this](unsigned char b) { put(b); }, v);
+    }
+
+    uint64_t elapsed(trace_clock::time_point& since, trace_clock::time_point now) {
+        auto ns = chrono::duration_cast<chrono::nanoseconds>(now - since).count();
+        since = now;
+        return uint64_t(ns);
+    }
+
+    void begin_tick(uint32_t agent, uint64_t tick) {
+        auto now = trace_clock::now();
+        reserve(32);
+        varint((uint64_t(timed ? record::TICK_BEGIN : record::TICK_BEGIN_UNTIMED) << 2) | control_bits);
+        varint(agent);
+        varint(tick);
+        varint(elapsed(last_tick, now));
+        last_event = now;
+        last_node = 0;
+        active() = this;
+    }
+
+    void event(uint32_t node, status s) {
+        reserve(24);
+        varint((zigzag(int64_t(node) - int64_t(last_node)) << 2) | uint64_t(s));
+        if (timed) {
+            varint(elapsed(last_event, trace_clock::now()));
+        }
+        last_node = node;
+    }
+
+    // Stages of concurrently ticked children overlap in time, so each appended event is timed from the
+    // later of its own time and the previous record.
+    void append(const TraceStage& stage) {
+        for (auto& e : stage.entries) {
+            reserve(24);
+            varint((zigzag(int64_t(e.node) - int64_t(last_node)) << 2) | uint64_t(e.result));
+            if (timed) {
+                varint(elapsed(last_event, max(e.time, last_event)));
+            }
+            last_node = e.node;
+        }
+    }
+
+    void end_tick() {
+        active() = nullptr;
+        tail.store(local_tail, memory_order_release);
+    }
+
+    // Consumer side
+    void drain(vector<unsigned char>& out) {
+        auto t = tail.load(memory_order_acquire);
+        auto h = head.load(memory_order_relaxed);
+        if (h == t) {
+            return;
+        }
+        auto first = h & mask;
+        auto last = t & mask;
+        if (first < last) {
+            out.insert(out.end(), ring.begin() + first, ring.begin() + last);
+        } else {
+            out.insert(out.end(), ring.begin() + first, ring.end());
+            out.insert(out.end(), ring.begin(), ring.begin() + last);
+        }
+        head.store(t, memory_order_release);
+    }
+};
+
+// Task pool adapter for traced parallel nodes. Every job of a batch records into a stage of its own,
+// and the stages are appended in job order to the trace of the thread that started the batch. One
+// adapter is kept per pool for the lifetime of the process.
+struct TracedPool : TaskPool {
+    TaskPool* pool;
+
+    explicit TracedPool(TaskPool* pool) : pool(pool) { }
+
+    static TaskPool* wrap(TaskPool* pool) {
+        static mutex registry_mutex;
+        static map<TaskPool*, unique_ptr<TracedPool>> registry;
+        if (!pool || dynamic_cast<TracedPool*>(pool)) {
+            return pool;
+        }
+        lock_guard<mutex> lock(registry_mutex);
+        auto& traced = registry[pool];
+        if (!traced) {
+            traced = make_unique<TracedPool>(pool);
+        }
+        return traced.get();
+    }
+
+    void run(size_t count, void (* job)(void*, size_t), void* ctx) override {
+        auto writer = TraceWriter::active();
+        auto outer = TraceStage::active();
+        if (!writer && !outer) {
+            pool->run(count, job, ctx);
+            return;
+        }
+        vector<TraceStage> stages(count);
+        for (auto& stage : stages) {
+            stage.timed = writer ? writer->timed : outer->timed;
+        }
+        auto staged = [&](size_t i) {
+            auto saved_writer = TraceWriter::active();
+            auto saved_stage = TraceStage::active();
+            TraceWriter::active() = nullptr;
+            TraceStage::active() = &stages[i];
+            job(ctx, i);
+            TraceWriter::active() = saved_writer;
+            TraceStage::active() = saved_stage;
+        };
+        pool->run(count, run_job<decltype(staged)>, &staged);
+        for (auto& stage : stages) {
+            if (writer) {
+                writer->append(stage);
+            } else {
+                outer->append(stage);
+            }
+        }
+    }
+};
+
+// Owns one TraceWriter per recording thread and streams their contents to `out` from a background
+// thread every `interval`. Everything recorded is flushed on destruction. Without `timed`, only
+// whole ticks are timestamped.
+struct TraceSink {
+    ostream& out;
+    trace_clock::time_point epoch = trace_clock::now();
+    uint64_t id;
+    mutex writers_mutex;
+    vector<unique_ptr<TraceWriter>> writers;
+    vector<unsigned char> buffer;
+    atomic<bool> running{true};
+    bool timed;
+    thread flusher;
+
+    TraceSink(ostream& out, bool timed = true, chrono::microseconds interval = chrono::microseconds(1000))
+            : out(out), id(next_id()), timed(timed), flusher([this, interval] {
+                while (running.load(memory_order_acquire)) {
+                    flush();
+                    this_thread::sleep_for(interval);
+                }
+            }) { }
+
+    TraceSink(const TraceSink&) = delete;
+
+    TraceSink& operator=(const TraceSink&) = delete;
+
+    ~TraceSink() {
+        running.store(false, memory_order_release);
+        flusher.join();
+        flush();
+    }
+
+    static uint64_t next_id() {
+        static atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    // This thread's writer, created on first use. Threads remember their writer for every sink they
+    // recorded to; entries of destroyed sinks are never looked up again, since ids are not reused.
+    TraceWriter& writer() {
+        struct cache_t {
+            uint64_t sink = 0;
+            TraceWriter* writer = nullptr;
+        };
+        static thread_local cache_t cache;
+        static thread_local map<uint64_t, TraceWriter*> by_sink;
+        if (cache.sink != id) {
+            auto& w = by_sink[id];
+            if (!w) {
+                lock_guard<mutex> lock(writers_mutex);
+                writers.push_back(make_unique<TraceWriter>(epoch));
+                writers.back()->timed = timed;
+                w = writers.back().get();
+            }
+            cache = {id, w};
+        }
+        return *cache.writer;
+    }
+
+    void flush() {
+        lock_guard<mutex> lock(writers_mutex);
+        auto put = [this](unsigned char b) { out.put(char(b)); };
+        for (size_t i = 0; i != writers.size(); ++i) {
+            buffer.clear();
+            writers[i]->drain(buffer);
+            if (!buffer.empty()) {
+                put_varint(put, i);
+                put_varint(put, buffer.size());
+                out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+            }
+        }
+        out.flush();
+    }
+};
+
+// Decoding
+
+struct TraceEvent {
+    uint32_t node;
+    status result;
+    uint64_t time; // ns since the start of the tick, 0 if untimed
+};
+
+struct TraceTick {
+    uint32_t agent;
+    uint64_t tick;
+    uint64_t start; // ns since the sink was created
+    vector<TraceEvent> events;
+};
+
+inline bool get_varint(const vector<unsigned char>& in, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; pos != in.size() && shift < 64; shift += 7) {
+        unsigned char b = in[pos++];
+        v |= uint64_t(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool get_varint(istream& in, uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        auto c = in.get();
+        if (c == istream::traits_type::eof()) {
+            return false;
+        }
+        v |= uint64_t(c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reads a whole log; ticks are grouped by recording thread, in recording order.
+inline vector<TraceTick> read_trace(istream& in) {
+    map<uint64_t, vector<unsigned char>> streams;
+    uint64_t writer;
+    uint64_t size;
+    while (get_varint(in, writer) && get_varint(in, size)) {
+        auto& s = streams[writer];
+        auto old = s.size();
+        s.resize(old + size);
+        in.read(reinterpret_cast<char*>(s.data() + old), size);
+        s.resize(old + size_t(in.gcount()));
+    }
+
+    vector<TraceTick> ticks;
+    for (auto& entry : streams) {
+        auto& s = entry.second;
+        size_t pos = 0;
+        uint64_t start = 0;
+        uint64_t head;
+        bool timed = true;
+        while (get_varint(s, pos, head)) {
+            if ((head & control_bits) == control_bits) {
+                timed = (record(head >> 2) == record::TICK_BEGIN);
+                uint64_t agent, tick, dt;
+                if (!(get_varint(s, pos, agent) && get_varint(s, pos, tick) && get_varint(s, pos, dt))) {
+                    break;
+                }
+                start += dt;
+                ticks.push_back({uint32_t(agent), tick, start, {}});
+            } else {
+                uint64_t dt = 0;
+                if (ticks.empty() || (timed && !get_varint(s, pos, dt))) {
+                    break;
+                }
+                auto& events = ticks.back().events;
+                int64_t last_node = events.empty() ? 0 : events.back().node;
+                uint64_t last_time = events.empty() ? 0 : events.back().time;
+                events.push_back({uint32_t(last_node + unzigzag(head >> 2)), status(head & control_bits),
+                                  last_time + dt});
+            }
+        }
+    }
+    return ticks;
+}
+
+} // namespace _detail_bait_trace
+
+using _detail_bait_trace::TraceWriter;
+using _detail_bait_trace::TraceStage;
+using _detail_bait_trace::TracedPool;
+using _detail_bait_trace::TraceSink;
+using _detail_bait_trace::TraceEvent;
+using _detail_bait_trace::TraceTick;
+using _detail_bait_trace::read_trace;
+
+} // namespace bait
+
+#endif //BEHAVIORTREEPROJ_BAIT_TRACE_HPP
@@ -0,0 +1,269 @@
+#ifndef BEHAVIORTREEPROJ_BAIT_TRACE_DYNAMIC_HPP
+#define BEHAVIORTREEPROJ_BAIT_TRACE_DYNAMIC_HPP
+
+#include "bait_dynamic.hpp"
+#include "bait_reload_dynamic.hpp"
+#include "bait_trace.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bait {
+
+template<typename BT>
+struct Tracer;
+
+// Numbers every node in preorder and wraps it so that its result is recorded to the calling thread's
+// active TraceWriter (see TraceWriter::begin_tick). Outside of a traced tick the wrappers only cost two
+// thread-local lookups. Parallel nodes have their pool wrapped in a TracedPool, so that children
+// ticked on pool threads are recorded too. Instrument after simplifying, so that the numbering
+// matches the tree that runs.
+template<typename... Args>
+struct Tracer<DynamicBT<Args...>> {
+    using BT = DynamicBT<Args...>;
+    using Func = typename BT::Func;
+
+    static void record(uint32_t node, status result) {
+        if (auto writer = TraceWriter::active()) {
+            writer->event(node, result);
+        } else if (auto stage = TraceStage::active()) {
+            stage->event(node, result);
+        }
+    }
+
+    Func instrument(Func tree, uint32_t& next) const {
+        using namespace std;
+        uint32_t id = next++;
+        if (auto par = tree.template target<typename BT::RawParallel>()) {
+            par->policy.pool = TracedPool::wrap(par->policy.pool);
+        }
+        for (size_t i = 0; auto c = Reloader<BT>::child(tree, i); ++i) {
+            *c = instrument(move(*c), next);
+        }
+        return typename BT::RawTraced(id, move(tree), record);
+    }
+
+    Func operator()(Func tree) const {
+        using namespace std;
+        uint32_t next = 0;
+        return instrument(move(tree), next);
+    }
+};
+
+template<typename BT>
+struct TraceReplay;
+
+// Offline analysis of a trace against the tree that produced it. The tree may be given with or
+// without its Tracer wrappers.
+template<typename... Args>
+struct TraceReplay<DynamicBT<Args...>> {
+    using BT = DynamicBT<Args...>;
+    using Func = typename BT::Func;
+
+    enum class kind {
+        OTHER,
+        SERIAL,
+        UTILITY,
+        PARALLEL
+    };
+
+    static constexpr size_t npos = size_t(-1);
+
+    // Reconstructed tick state: the `current` index of serial and utility nodes, and for every child of
+    // a parallel node its entry in the parent's results.
+    struct State {
+        std::vector<size_t> current;
+        std::vector<status> results;
+    };
+
+    std::vector<kind> kinds;
+    std::vector<size_t> parents;
+    std::vector<size_t> positions;
+    std::vector<size_t> subtree_sizes;
+
+    explicit TraceReplay(const Func& tree) {
+        number(tree, npos, 0);
+    }
+
+    template<typename F>
+    static F& unwrap(F& tree) {
+        if (auto ptr = tree.template target<typename BT::RawTraced>()) {
+            return ptr->child;
+        }
+        return tree;
+    }
+
+    static kind kind_of(const Func& tree) {
+        if (tree.template target<typename BT::RawSequence>() || tree.template target<typename BT::RawSelector>()) {
+            return kind::SERIAL;
+        } else if (tree.template target<typename BT::RawUtility>()) {
+            return kind::UTILITY;
+        } else if (tree.template target<typename BT::RawParallel>()) {
+            return kind::PARALLEL;
+        } else {
+            return kind::OTHER;
+        }
+    }
+
+    void number(const Func& traced, size_t parent, size_t position) {
+        auto& tree = unwrap(traced);
+        auto id = kinds.size();
+        kinds.push_back(kind_of(tree));
+        parents.push_back(parent);
+        positions.push_back(position);
+        subtree_sizes.push_back(1);
+        for (size_t i = 0; auto c = Reloader<BT>::child(tree, i); ++i) {
+            number(*c, id, i);
+        }
+        subtree_sizes[id] = kinds.size() - id;
+    }
+
+    bool is_descendant(size_t node, size_t of) const {
+        return node > of && node < of + subtree_sizes[of];
+    }
+
+    size_t child_of(size_t node, size_t position) const {
+        auto c = node + 1;
+        for (; position != 0; --position) {
+            c += subtree_sizes[c];
+        }
+        return c;
+    }
+
+    // Puts a subtree back into its initial state the way DynamicBT::reset does for the live tree: only
+    // the running path is followed, so finished utility nodes elsewhere keep their choice.
+    void reset(State& s, size_t node) const {
+        switch (kinds[node]) {
+            case kind::SERIAL:
+                if (subtree_sizes[node] != 1) {
+                    reset(s, child_of(node, s.current[node]));
+                }
+                s.current[node] = 0;
+                break;
+            case kind::UTILITY:
+                if (s.current[node] != npos) {
+                    reset(s, child_of(node, s.current[node]));
+                }
+                s.current[node] = npos;
+                break;
+            case kind::PARALLEL:
+                restart(s, node);
+                break;
+            default:
+                if (subtree_sizes[node] != 1) {
+                    reset(s, node + 1);
+                }
+                break;
+        }
+    }
+
+    // Resets the children of a parallel node that were left RUNNING, as RawParallel::restart does.
+    void restart(State& s, size_t node) const {
+        for (auto c = node + 1; c != node + subtree_sizes[node]; c += subtree_sizes[c]) {
+            if (s.results[c] == status::RUNNING) {
+                reset(s, c);
+            }
+            s.results[c] = status::RUNNING;
+        }
+    }
+
+    // The tick state after replaying the agent's ticks up to and including `until`. Ticks are expected
+    // in recording order.
+    State state(const std::vector<TraceTick>& ticks, uint32_t agent, uint64_t until) const {
+        State s{std::vector<size_t>(kinds.size(), 0), std::vector<status>(kinds.size(), status::RUNNING)};
+        for (size_t i = 0; i != kinds.size(); ++i) {
+            if (kinds[i] == kind::UTILITY) {
+                s.current[i] = npos;
+            }
+        }
+        std::vector<size_t> last_child(kinds.size(), 0);
+        for (auto& t : ticks) {
+            if (t.agent != agent || t.tick > until) {
+                continue;
+            }
+            for (auto& e : t.events) {
+                auto node = e.node;
+                if (node >= kinds.size()) {
+                    continue;
+                }
+                auto parent = parents[node];
+                if (parent != npos) {
+                    last_child[parent] = positions[node];
+                    if (kinds[parent] == kind::PARALLEL) {
+                        s.results[node] = e.result;
+                    }
+                }
+                switch (kinds[node]) {
+                    case kind::SERIAL:
+                        s.current[node] = (e.result == status::RUNNING ? last_child[node] : 0);
+                        break;
+                    case kind::UTILITY:
+                        // An abandoned option is reset when the utility switches away from it
+                        if (s.current[node] != npos && s.current[node] != last_child[node]) {
+                            reset(s, child_of(node, s.current[node]));
+                        }
+                        s.current[node] = last_child[node];
+                        break;
+                    case kind::PARALLEL:
+                        if (e.result != status::RUNNING) {
+                            restart(s, node);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+        return s;
+    }
+
+    // Writes a state produced by state() into a tree built from the same description.
+    void restore(Func& tree, const State& s) const {
+        size_t next = 0;
+        restore(tree, s, next);
+    }
+
+    void restore(Func& traced, const State& s, size_t& next) const {
+        auto& tree = unwrap(traced);
+        auto id = next++;
+        if (auto ptr = tree.template target<typename BT::RawSequence>()) {
+            ptr->current = s.current[id];
+        } else if (auto ptr = tree.template target<typename BT::RawSelector>()) {
+            ptr->current = s.current[id];
+        } else if (auto ptr = tree.template target<typename BT::RawUtility>()) {
+            ptr->current = s.current[id];
+        } else if (auto ptr = tree.template target<typename BT::RawParallel>()) {
+            for (size_t i = 0; i != ptr->results.size(); ++i) {
+                ptr->results[i] = s.results[child_of(id, i)];
+            }
+        }
+        for (size_t i = 0; auto c = Reloader<BT>::child(tree, i); ++i) {
+            restore(*c, s, next);
+        }
+    }
+
+    // Inclusive ns spent in every node during one tick.
+    std::vector<uint64_t> timings(const TraceTick& tick) const {
+        std::vector<uint64_t> result(kinds.size(), 0);
+        auto& events = tick.events;
+        for (size_t k = 0; k != events.size(); ++k) {
+            auto node = events[k].node;
+            if (node >= kinds.size()) {
+                continue;
+            }
+            // Events are recorded on exit, so the node's descendants are the events right before it.
+            size_t j = k;
+            while (j != 0 && is_descendant(events[j - 1].node, node)) {
+                --j;
+            }
+            uint64_t start = (j == 0 ? 0 : events[j - 1].time);
+            result[node] += events[k].time - start;
+        }
+        return result;
+    }
+};
+
+} // namespace bait
+
+#endif //BEHAVIORTREEPROJ_BAIT_TRACE_DYNAMIC_HPP
@@ -0,0 +1,89 @@
+#ifndef BEHAVIORTREEPROJ_BAIT_UTILITY_DYNAMIC_HPP
+#define BEHAVIORTREEPROJ_BAIT_UTILITY_DYNAMIC_HPP
+
+#include "bait_dynamic.hpp"
+#include "bait_reload_dynamic.hpp"
+
+#include <string>
+#include <vector>
+
+namespace bait {
+
+template<typename BT>
+struct UtilityBatch;
+
+// Scores one utility node across a population in a single pass. The node is the child of the
+// subtree named `name` in every tree of the population, seen through Tracer wrappers; trees without
+// it, or whose node differs in option count or hysteresis from the first one found, are left to
+// score themselves. select() fills a child-major score table, picks every agent's option with the
+// batched best_utility and preselects it for the node's next tick. Call expire() once the agents
+// due this frame have ticked: agents that were not ticked, or whose tick did not reach the node,
+// drop their preselection and score for themselves later. Like StateMap it refers into the trees,
+// so rebuild it after they change.
+template<typename... Args>
+struct UtilityBatch<DynamicBT<Args...>> {
+    using BT = DynamicBT<Args...>;
+    using Func = typename BT::Func;
+
+    std::vector<typename BT::RawUtility*> nodes;
+    std::vector<size_t> agents;
+    std::vector<float> scores;
+    std::vector<float> best_scores;
+    std::vector<size_t> choices;
+
+    template<typename Iter>
+    UtilityBatch(Iter first, Iter last, const std::string& name) {
+        typename Reloader<BT>::Path path;
+        for (size_t agent = 0; first != last; ++first, ++agent) {
+            auto named = Reloader<BT>().find(*first, name, path);
+            auto child = named ? Reloader<BT>::child(*named, 0) : nullptr;
+            while (auto traced = child ? child->template target<typename BT::RawTraced>() : nullptr) {
+                child = &traced->child;
+            }
+            auto node = child ? child->template target<typename BT::RawUtility>() : nullptr;
+            if (node && (nodes.empty() || (node->children.size() == nodes.front()->children.size() &&
+                                           node->hysteresis == nodes.front()->hysteresis))) {
+                nodes.push_back(node);
+                agents.push_back(agent);
+            }
+        }
+        auto options = nodes.empty() ? 0 : nodes.front()->children.size();
+        scores.resize(options * nodes.size());
+        best_scores.resize(nodes.size());
+        choices.resize(nodes.size());
+    }
+
+    // score(agent, option_score) evaluates one option's Score with that agent's arguments, where
+    // `agent` is the tree's position in the population.
+    template<typename ScoreFn>
+    void select(ScoreFn&& score) {
+        auto count = nodes.size();
+        if (count == 0 || nodes.front()->children.empty()) {
+            return;
+        }
+        auto options = nodes.front()->children.size();
+        for (size_t i = 0; i != options; ++i) {
+            for (size_t k = 0; k != count; ++k) {
+                scores[i * count + k] = score(agents[k], nodes[k]->scores[i]);
+            }
+        }
+        for (size_t k = 0; k != count; ++k) {
+            choices[k] = nodes[k]->current;
+        }
+        best_utility(scores.data(), options, count, choices.data(), best_scores.data(),
+                     nodes.front()->hysteresis);
+        for (size_t k = 0; k != count; ++k) {
+            nodes[k]->preselect(choices[k]);
+        }
+    }
+
+    void expire() {
+        for (auto node : nodes) {
+            node->preselect(size_t(-1));
+        }
+    }
+};
+
+} // namespace bait
+
+#endif //BEHAVIORTREEPROJ_BAIT_UTILITY_DYNAMIC_HPP
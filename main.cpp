@@ -5,7 +5,19 @@
 #include "bait/bait_print_static.hpp"
 #include "bait/bait_print_dynamic.hpp"
 
+#include "bait/bait_bridge.hpp"
+#include "bait/bait_dsl_static.hpp"
+#include "bait/bait_lod_dynamic.hpp"
+#include "bait/bait_reload_dynamic.hpp"
+#include "bait/bait_task_pool.hpp"
+#include "bait/bait_snapshot_dynamic.hpp"
+#include "bait/bait_snapshot_static.hpp"
+#include "bait/bait_trace_dynamic.hpp"
+#include "bait/bait_utility_dynamic.hpp"
+
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 using namespace std;
 
@@ -67,6 +79,235 @@ auto behavior =
         );
 auto behavior2 = simplify(behavior);
 
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        cerr << "FAILED: " << what << endl;
+        ++failures;
+    }
+}
+
+using DBT = bait::DynamicBT<>;
+
+int ticks_left = 0;
+status succeed_later() { return --ticks_left > 0 ? status::RUNNING : status::SUCCESS; }
+status fail() { return status::FAILURE; }
+status run() { return status::RUNNING; }
+int steps = 0;
+status step() { ++steps; return status::SUCCESS; }
+float low() { return 0.2f; }
+float high() { return 0.8f; }
+
+// Thread safe children of a pooled parallel run on the pool and report back in order.
+void test_pool() {
+    bait::ThreadPool pool(3);
+    auto all = DBT::parallel(bait::require_all(&pool),
+                             DBT::thread_safe(attack), DBT::thread_safe(stand), DBT::thread_safe(find_player));
+    check(all() == status::SUCCESS, "pool: require_all succeeds");
+    auto one = DBT::parallel(bait::require_one(&pool), DBT::thread_safe(fail), DBT::thread_safe(run));
+    check(one() == status::RUNNING, "pool: require_one keeps running");
+    auto none = DBT::parallel(bait::require_one(&pool), DBT::thread_safe(fail), DBT::thread_safe(fail));
+    check(none() == status::FAILURE, "pool: require_one fails");
+    auto nested = DBT::parallel(bait::require_all(&pool),
+                                DBT::thread_safe(DBT::parallel(bait::require_all(&pool), DBT::thread_safe(attack),
+                                                               DBT::thread_safe(stand))),
+                                DBT::thread_safe(find_player));
+    for (int tick = 0; tick < 100; ++tick) {
+        check(nested() == status::SUCCESS, "pool: nested parallel on the same pool succeeds");
+    }
+}
+
+// A traced tree is written out, read back, and replayed onto a fresh copy of the tree.
+void test_trace() {
+    bait::ThreadPool pool(2);
+    auto make = [&] {
+        return DBT::parallel(bait::require_all(&pool), DBT::thread_safe(attack), DBT::thread_safe(succeed_later),
+                             DBT::sequence(walk_randomly, run));
+    };
+    stringstream log;
+    ticks_left = 3;
+    DBT::Func tree = bait::Tracer<DBT>()(make());
+    {
+        bait::TraceSink sink(log, false);
+        auto& writer = sink.writer();
+        for (uint64_t tick = 0; tick < 2; ++tick) {
+            writer.begin_tick(1, tick);
+            check(tree() == status::RUNNING, "trace: parallel keeps running");
+            writer.end_tick();
+        }
+    }
+    auto ticks = bait::read_trace(log);
+    check(ticks.size() == 2, "trace: every tick read back");
+    check(!ticks.empty() && ticks.front().events.size() == 8, "trace: pooled children recorded");
+
+    DBT::Func fresh = make();
+    bait::TraceReplay<DBT> replay(fresh);
+    replay.restore(fresh, replay.state(ticks, 1, 1));
+    auto live = tree.target<DBT::RawTraced>()->child.target<DBT::RawParallel>();
+    auto restored = fresh.target<DBT::RawParallel>();
+    check(live->results == restored->results, "trace: parallel results replayed");
+    check(restored->children[2].target<DBT::RawSequence>()->current == 1, "trace: sequence position replayed");
+
+    // The parallel finishes while the sequence is still running; the utility inside it had already
+    // finished and keeps its choice.
+    auto make_early = [] {
+        return DBT::parallel(bait::require_one(), succeed_later,
+                             DBT::sequence(DBT::utility(0.1f, DBT::option(low, stand), DBT::option(high, attack)), run));
+    };
+    stringstream early_log;
+    ticks_left = 2;
+    DBT::Func early = bait::Tracer<DBT>()(make_early());
+    {
+        bait::TraceSink sink(early_log, false);
+        auto& writer = sink.writer();
+        for (uint64_t tick = 0; tick < 2; ++tick) {
+            writer.begin_tick(2, tick);
+            early();
+            writer.end_tick();
+        }
+    }
+    DBT::Func fresh_early = make_early();
+    bait::TraceReplay<DBT> early_replay(fresh_early);
+    early_replay.restore(fresh_early, early_replay.state(bait::read_trace(early_log), 2, 1));
+    check(bait::StateMap<DBT>(early).save() == bait::StateMap<DBT>(fresh_early).save(),
+          "trace: finished utility keeps its choice in replay");
+}
+
+// Swapping a named subtree keeps its position only where the children already run are unchanged, and
+// keeps the old nodes wherever the replacement is unchanged.
+void test_reload() {
+    bait::Reloader<DBT> reloader;
+    DBT::Func tree = DBT::named("combat", DBT::sequence(attack, run, stand));
+    tree();
+    reloader.swap(tree, "combat", DBT::sequence(fail, attack, run));
+    check(tree() == status::FAILURE, "reload: changed children start over");
+
+    tree = DBT::named("combat", DBT::sequence(attack, DBT::sequence(stand, run)));
+    tree();
+    auto named = tree.target<DBT::RawNamed>();
+    auto running = named->child.target<DBT::RawSequence>()->children[1].target<DBT::RawSequence>();
+    reloader.swap(tree, "combat", DBT::sequence(attack, DBT::sequence(stand, run), stand));
+    auto swapped = named->child.target<DBT::RawSequence>();
+    check(swapped->current == 1, "reload: unchanged children keep the position");
+    check(swapped->children[1].target<DBT::RawSequence>() == running && running->current == 1,
+          "reload: unchanged nodes are reused with their state");
+}
+
+// Changing an agent's level keeps its position, even where the full level ticks a variant that a
+// reduced level skips.
+void test_lod() {
+    auto reduced = bait::StaticBT::reduce_lod<1>(
+            bait::StaticBT::sequence(attack, bait::StaticBT::lod(walk_randomly, bait::StaticBT::succeed()), run));
+    check(reduced() == status::RUNNING, "lod: skipped variant lets the sequence continue");
+
+    DBT::Func tree = DBT::sequence(attack, DBT::lod(DBT::sequence(walk_randomly, stand), DBT::succeed()), stand, run);
+    bait::LodRunner<DBT, bait::Optimization::ALL> runner(tree, {1, 2});
+    auto agent = runner.add_agent();
+    runner.tick([](size_t, DBT::Func& t) { return t(); });
+    runner.set_lod(agent, 1);
+    check(runner.agents[agent].tree.target<DBT::RawSequence>()->current == 3, "lod: position kept across levels");
+    runner.set_lod(agent, 0);
+    check(runner.agents[agent].tree.target<DBT::RawSequence>()->current == 3, "lod: position kept back at full detail");
+}
+
+// A restored tree resumes where the snapshot was taken instead of where it was left.
+void test_snapshot() {
+    auto tree = bait::StaticBT::sequence(step, succeed_later, step);
+    ticks_left = 2;
+    tree();
+    auto saved = bait::snapshot(tree);
+    tree();
+    bait::restore(tree, saved);
+    check(bait::snapshot(tree) == saved, "snapshot: static state restored");
+    steps = 0;
+    ticks_left = 1;
+    check(tree() == status::SUCCESS && steps == 1, "snapshot: static tree resumes at the running child");
+
+    auto choice = DBT::utility(0.1f, DBT::option(low, stand), DBT::option(high, succeed_later));
+    DBT::Func dynamic = DBT::sequence(step, choice, step);
+    bait::StateMap<DBT> map(dynamic);
+    ticks_left = 2;
+    dynamic();
+    auto buffer = map.save();
+    dynamic();
+    map.restore(buffer.data());
+    check(map.save() == buffer, "snapshot: dynamic state restored");
+    steps = 0;
+    ticks_left = 1;
+    check(dynamic() == status::SUCCESS && steps == 1, "snapshot: dynamic tree resumes at the running child");
+}
+
+// A dynamic slot inside an embedded static tree is simplified, printed and snapshotted along with the
+// tree around it.
+void test_bridge() {
+    using Bridge = bait::Bridge<DBT>;
+    auto inverted = Bridge::embed(bait::StaticBT::sequence(stand, Bridge::slot(DBT::inverter(DBT::inverter(run)))));
+    DBT::Func simplified = bait::Simplifier<DBT, bait::Optimization::ALL>()(DBT::sequence(attack, inverted));
+    stringstream printed;
+    bait::print_dynamic(printed, simplified, "");
+    check(printed.str().find("dynamic(") != string::npos, "bridge: printer sees the slot");
+    check(printed.str().find("inverter") == string::npos, "bridge: slot simplified through the static tree");
+    check(simplified() == status::RUNNING, "bridge: simplified tree runs the slot");
+
+    auto make = [] {
+        return DBT::sequence(attack, Bridge::embed(bait::StaticBT::sequence(
+                stand, Bridge::slot(DBT::sequence(step, succeed_later, step)))));
+    };
+    DBT::Func tree = make();
+    ticks_left = 2;
+    tree();
+    auto buffer = bait::StateMap<DBT>(tree).save();
+    DBT::Func fresh = make();
+    bait::StateMap<DBT> map(fresh);
+    map.restore(buffer.data());
+    check(map.save() == buffer, "bridge: slot state restored");
+    steps = 0;
+    ticks_left = 1;
+    check(fresh() == status::SUCCESS && steps == 1, "bridge: restored slot resumes at the running child");
+}
+
+// Batched choices apply on the agents' next tick only; traced trees take part like any other.
+void test_utility() {
+    auto make = [] {
+        return DBT::named("choice", DBT::utility(0.1f, DBT::option(low, stand), DBT::option(high, attack)));
+    };
+    vector<DBT::Func> agents{make(), make(), bait::Tracer<DBT>()(make())};
+    bait::UtilityBatch<DBT> batch(agents.begin(), agents.end(), "choice");
+    check(batch.nodes.size() == 3, "utility: traced tree joins the batch");
+    // Agent 1 prefers the option its own scores rank lowest
+    batch.select([](size_t agent, const DBT::Score& score) { return agent == 1 ? 1 - score() : score(); });
+    agents[0]();
+    agents[2]();
+    batch.expire();
+    check(batch.nodes[0]->current == 1 && batch.nodes[2]->current == 1, "utility: ticked agents use the batch");
+    check(batch.nodes[1]->current == size_t(-1), "utility: agents not ticked keep their choice");
+    agents[1]();
+    check(batch.nodes[1]->current == 1, "utility: expired preselection scores on its own");
+}
+
+struct Patrol {
+    static constexpr const char* leaves() { return "find_player, player_in_range, attack, walk_randomly, stand"; }
+    static constexpr const char* tree() {
+        return "sequence(until_fail(find_player), selector(sequence(player_in_range, !!attack), fail), "
+               "until_fail(selector(!sequence(walk_randomly), stand)), sequence(succeed, stand))";
+    }
+};
+
+// The simplified DSL tree behaves like the tree exactly as written.
+void test_dsl() {
+    auto raw = bait::StaticDSL<Patrol>::make_raw(find_player, player_in_range, attack, walk_randomly, stand);
+    auto quick = bait::StaticDSL<Patrol, bait::Optimization::QUICK>::make(
+            find_player, player_in_range, attack, walk_randomly, stand);
+    auto all = bait::StaticDSL<Patrol, bait::Optimization::ALL>::make(
+            find_player, player_in_range, attack, walk_randomly, stand);
+    for (int tick = 0; tick < 3; ++tick) {
+        auto expected = raw();
+        check(quick() == expected, "dsl: QUICK matches the raw tree");
+        check(all() == expected, "dsl: ALL matches the raw tree");
+    }
+}
+
 int main() {
     cout << "BEFORE SIMPLIFY:" << endl;
     print(cout, behavior, "    ");
@@ -78,4 +319,15 @@ int main() {
 
     cout << "Sizeof behavior:  " << sizeof(behavior) << endl;
     cout << "Sizeof behavior2: " << sizeof(behavior2) << endl;
+
+    test_pool();
+    test_trace();
+    test_reload();
+    test_lod();
+    test_snapshot();
+    test_bridge();
+    test_utility();
+    test_dsl();
+    cout << (failures ? "Checks failed!" : "Checks passed!") << endl;
+    return failures ? 1 : 0;
 }